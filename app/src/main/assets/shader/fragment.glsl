@@ -1,7 +1,14 @@
 #version 300 es
+precision mediump float;
+
 uniform sampler2D texture0;
 uniform sampler2D texture1;
 
+layout (std140) uniform Material {
+    vec4 uTint;
+    float uTextureMix;
+};
+
 in vec2 TexCoord;
 in vec3 vertexColor;
 
@@ -14,5 +21,6 @@ void main() {
 //    // 左右翻转
 //    vec2 horiztalFlip = vec2(1.0 - TexCoord.s, TexCoord.t);
 //    vec4 t1 = texture(texture1, horiztalFlip);
-    FragColor = mix(t0, t1, 0.2F);
+    // 叠加图只按自身的alpha覆盖颜色, 输出的alpha只取决于精灵图片和色调, 不透明的材质因此保持不透明
+    FragColor = vec4(mix(t0.rgb, t1.rgb, uTextureMix * t1.a), t0.a) * uTint;
 }
\ No newline at end of file
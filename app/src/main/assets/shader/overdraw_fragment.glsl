@@ -0,0 +1,9 @@
+#version 300 es
+precision mediump float;
+
+out vec4 FragColor;
+
+// 叠加混合下每个片元加一份, 红色8层饱和, 绿色16层, 蓝色32层
+void main() {
+    FragColor = vec4(1.0 / 8.0, 1.0 / 16.0, 1.0 / 32.0, 1.0);
+}
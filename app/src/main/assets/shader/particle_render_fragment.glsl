@@ -0,0 +1,13 @@
+#version 300 es
+precision mediump float;
+
+uniform sampler2D uTexture;
+
+in float vFade;
+
+out vec4 FragColor;
+
+void main() {
+    vec4 color = texture(uTexture, vec2(gl_PointCoord.x, 1.0 - gl_PointCoord.y));
+    FragColor = vec4(color.rgb, color.a * vFade);
+}
\ No newline at end of file
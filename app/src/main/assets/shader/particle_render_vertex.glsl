@@ -0,0 +1,42 @@
+#version 300 es
+layout (location = 0) in vec4 aPositionAge;
+layout (location = 1) in vec4 aVelocityLifetime;
+
+layout (std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;
+    float uTime;
+    float uDeltaTime;
+    // 动态分辨率的当前比例, 像素单位的尺寸要乘上它
+    float uResolutionScale;
+};
+
+layout (std140) uniform Emitter {
+    vec4 uEmitterPosition;
+    vec4 uEmitterDirection;
+    vec4 uGravity;
+    float uEmitterSpread;
+    float uSpeedMin;
+    float uSpeedMax;
+    float uLifetimeMin;
+    float uLifetimeMax;
+    float uPointSize;
+    // 第一帧为1, 忽略输入把所有粒子错开出生时间
+    float uReset;
+};
+
+out float vFade;
+
+void main() {
+    float life = aPositionAge.w / aVelocityLifetime.w;
+    if (aPositionAge.w < 0.0) {
+        // 还没出生的粒子放到裁剪空间外面
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 0.0;
+        vFade = 0.0;
+        return;
+    }
+    gl_Position = uViewProjection * vec4(aPositionAge.xyz, 1.0);
+    gl_PointSize = uPointSize * uResolutionScale;
+    vFade = 1.0 - life;
+}
\ No newline at end of file
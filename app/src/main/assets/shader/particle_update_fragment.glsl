@@ -0,0 +1,9 @@
+#version 300 es
+// 更新阶段开启了 GL_RASTERIZER_DISCARD, 这个片段着色器只是为了满足程序链接的要求
+precision mediump float;
+
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(0.0);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#version 300 es
+// 粒子模拟: 由变换反馈把输出写回另一个VBO, 光栅化被关闭
+layout (location = 0) in vec4 aPositionAge;
+layout (location = 1) in vec4 aVelocityLifetime;
+
+layout (std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;
+    float uTime;
+    float uDeltaTime;
+    // 动态分辨率的当前比例, 像素单位的尺寸要乘上它
+    float uResolutionScale;
+};
+
+layout (std140) uniform Emitter {
+    vec4 uEmitterPosition;
+    vec4 uEmitterDirection;
+    vec4 uGravity;
+    float uEmitterSpread;
+    float uSpeedMin;
+    float uSpeedMax;
+    float uLifetimeMin;
+    float uLifetimeMax;
+    float uPointSize;
+    // 第一帧为1, 忽略输入把所有粒子错开出生时间
+    float uReset;
+};
+
+out vec4 vPositionAge;
+out vec4 vVelocityLifetime;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint seed) {
+    seed = hash(seed);
+    return float(seed) * (1.0 / 4294967295.0);
+}
+
+void main() {
+    vec3 position = aPositionAge.xyz;
+    float age = aPositionAge.w + uDeltaTime;
+    vec3 velocity = aVelocityLifetime.xyz;
+    float lifetime = aVelocityLifetime.w;
+
+    if (uReset > 0.5 || age >= lifetime) {
+        uint seed = hash(uint(gl_VertexID)) ^ floatBitsToUint(uTime);
+        float angle = (random(seed) * 2.0 - 1.0) * uEmitterSpread;
+        float c = cos(angle);
+        float s = sin(angle);
+        vec3 direction = vec3(
+                c * uEmitterDirection.x - s * uEmitterDirection.y,
+                s * uEmitterDirection.x + c * uEmitterDirection.y,
+                uEmitterDirection.z);
+        lifetime = mix(uLifetimeMin, uLifetimeMax, random(seed));
+        velocity = direction * mix(uSpeedMin, uSpeedMax, random(seed));
+        position = uEmitterPosition.xyz;
+        // 负的年龄表示还没出生, 这样重置后粒子会陆续发射而不是同时喷出
+        age = uReset > 0.5 ? -random(seed) * lifetime : 0.0;
+    } else if (age > 0.0) {
+        velocity += uGravity.xyz * uDeltaTime;
+        position += velocity * uDeltaTime;
+    }
+
+    vPositionAge = vec4(position, age);
+    vVelocityLifetime = vec4(velocity, lifetime);
+}
\ No newline at end of file
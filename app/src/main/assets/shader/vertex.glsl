@@ -2,12 +2,26 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec2 aTexCoord;
+// 每个实例一份: 旋转缩放矩阵的两列, 以及世界坐标
+layout (location = 3) in vec4 aInstanceBasis;
+layout (location = 4) in vec4 aInstanceTranslation;
+
+layout (std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;
+    float uTime;
+    float uDeltaTime;
+    // 动态分辨率的当前比例, 像素单位的尺寸要乘上它
+    float uResolutionScale;
+};
 
 out vec3 vertexColor;
 out vec2 TexCoord;
 
 void main() {
-    gl_Position = vec4(aPos, 1.0);
+    mat2 basis = mat2(aInstanceBasis.xy, aInstanceBasis.zw);
+    vec3 worldPos = vec3(basis * aPos.xy, aPos.z) + aInstanceTranslation.xyz;
+    gl_Position = uViewProjection * vec4(worldPos, 1.0);
     vertexColor = aColor;
     TexCoord = aTexCoord;
 }
\ No newline at end of file
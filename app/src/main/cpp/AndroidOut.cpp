@@ -1,7 +1,7 @@
 #include "AndroidOut.h"
 
-AndroidOut androidDebug("GL_ES");
-std::ostream debug(&androidDebug);
+thread_local AndroidOut androidDebug("GL_ES");
+thread_local std::ostream debug(&androidDebug);
 
-AndroidOut androidWarn("GL_ES", ANDROID_LOG_WARN);
-std::ostream warn(&androidWarn);
\ No newline at end of file
+thread_local AndroidOut androidWarn("GL_ES", ANDROID_LOG_WARN);
+thread_local std::ostream warn(&androidWarn);
\ No newline at end of file
@@ -2,40 +2,76 @@
 #define ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
 
 #include <android/log.h>
-#include <sstream>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
 
 /*!
  * Use this to log strings out to logcat. Note that you should use std::endl to commit the line
  *
  * ex:
  *  aout << "Hello World" << std::endl;
+ *
+ * Every thread gets its own stream, so job system workers can log without interleaving lines.
  */
-extern std::ostream debug;
-extern std::ostream warn;
+extern thread_local std::ostream debug;
+extern thread_local std::ostream warn;
 
 /*!
  * Use this class to create an output stream that writes to logcat. By default, a global one is
  * defined as @a aout
+ *
+ * Formats into a fixed buffer, so logging never allocates. A message longer than the buffer is
+ * split into several log entries, at the last line break that fits when there is one.
  */
-class AndroidOut : public std::stringbuf {
+class AndroidOut : public std::streambuf {
 public:
+    //! logcat truncates entries a little above 4000 bytes anyway
+    static constexpr size_t kBufferSize = 1024;
+
     /*!
      * Creates a new output stream for logcat
      * @param kLogTag the log tag to output
      */
     inline AndroidOut(const char *kLogTag, const int level = ANDROID_LOG_DEBUG)
-            : level_(level), logTag_(kLogTag) {}
+            : level_(level), logTag_(kLogTag) {
+        // 留一个字节放结尾的 '\0'
+        setp(buffer_, buffer_ + kBufferSize - 1);
+    }
 
 protected:
     virtual int sync() override {
-        __android_log_print(level_, logTag_, "%s", str().c_str());
-        str("");
+        _write(pptr());
         return 0;
     }
 
+    virtual int_type overflow(int_type ch) override {
+        auto split = pptr();
+        while (split != pbase() && split[-1] != '\n') --split;
+        _write(split == pbase() ? pptr() : split);
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
 private:
+    //! logs the buffer up to @a end, keeps the rest for the next entry
+    void _write(char *end) {
+        auto rest = pptr() - end;
+        auto kept = *end;
+        *end = '\0';
+        __android_log_write(level_, logTag_, buffer_);
+        *end = kept;
+        std::memmove(buffer_, end, rest);
+        setp(buffer_, buffer_ + kBufferSize - 1);
+        pbump(static_cast<int>(rest));
+    }
+
     const int level_;
     const char *logTag_;
+    char buffer_[kBufferSize];
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
\ No newline at end of file
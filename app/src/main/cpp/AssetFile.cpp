@@ -0,0 +1,18 @@
+#include "AssetFile.h"
+
+bool readAssetFile(AAssetManager *assetManager, const std::string &path, std::string &contents) {
+    auto asset = AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_BUFFER);
+    if (!asset) {
+        contents.clear();
+        return false;
+    }
+    auto length = AAsset_getLength(asset);
+    contents.resize(length);
+    auto read = AAsset_read(asset, &contents[0], length);
+    AAsset_close(asset);
+    if (read != length) {
+        contents.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#ifndef EGL_LEARNING_ASSETFILE_H
+#define EGL_LEARNING_ASSETFILE_H
+
+#include <android/asset_manager.h>
+#include <string>
+
+/*!
+ * Reads a whole asset into @a contents, reusing its capacity. The string stays NUL terminated,
+ * so text assets such as shader sources can be passed on as C strings.
+ * @return false if the asset could not be opened, @a contents is cleared then
+ */
+bool readAssetFile(AAssetManager *assetManager, const std::string &path, std::string &contents);
+
+
+#endif //EGL_LEARNING_ASSETFILE_H
@@ -0,0 +1,170 @@
+#include "DamageTracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "AndroidOut.h"
+#include "GlTrace.h"
+
+static bool hasExtension(const char *extensions, const char *name) {
+    if (!extensions) return false;
+    auto length = std::strlen(name);
+    for (auto found = std::strstr(extensions, name); found; found = std::strstr(found + 1, name)) {
+        // 必须是完整的名字, 不能只是另一个扩展名的前缀
+        auto end = found[length];
+        if ((found == extensions || found[-1] == ' ') && (end == ' ' || end == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * Damage lists cannot express "nothing changed": an empty list means the whole surface. A single
+ * pixel is the smallest region that can be passed instead, and is already correct in the buffer.
+ */
+static DamageRect nonEmpty(const DamageRect &rect) {
+    return rect.isEmpty() ? DamageRect{0, 0, 1, 1} : rect;
+}
+
+DamageRect DamageRect::united(const DamageRect &o) const {
+    if (isEmpty()) return o;
+    if (o.isEmpty()) return *this;
+    auto left = std::min(x, o.x);
+    auto bottom = std::min(y, o.y);
+    auto right = std::max(x + width, o.x + o.width);
+    auto top = std::max(y + height, o.y + o.height);
+    return {left, bottom, right - left, top - bottom};
+}
+
+DamageRect DamageTracker::Region::bounds() const {
+    DamageRect result{0, 0, 0, 0};
+    for (int i = 0; i < count; ++i) {
+        result = result.united(rects[i]);
+    }
+    return result;
+}
+
+DamageTracker::DamageTracker()
+        : display_(EGL_NO_DISPLAY),
+          surface_(EGL_NO_SURFACE),
+          width_(0),
+          height_(0),
+          bufferAge_(false),
+          setDamageRegion_(nullptr),
+          swapWithDamage_(nullptr),
+          full_(true),
+          current_{},
+          history_{},
+          historyCount_(0) {}
+
+void DamageTracker::init(EGLDisplay display, EGLSurface surface) {
+    display_ = display;
+    surface_ = surface;
+
+    auto extensions = eglQueryString(display, EGL_EXTENSIONS);
+    // KHR_partial_update 自带 EGL_BUFFER_AGE_KHR, 和 EXT 版本的枚举值相同
+    auto partialUpdate = hasExtension(extensions, "EGL_KHR_partial_update");
+    bufferAge_ = partialUpdate || hasExtension(extensions, "EGL_EXT_buffer_age");
+    if (partialUpdate) {
+        setDamageRegion_ = reinterpret_cast<PFNEGLSETDAMAGEREGIONKHRPROC>(
+                eglGetProcAddress("eglSetDamageRegionKHR"));
+    }
+    if (hasExtension(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+        swapWithDamage_ = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+                eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    } else if (hasExtension(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+        swapWithDamage_ = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+                eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+    }
+
+    debug << "damage tracking:"
+          << " [buffer age: " << bufferAge_ << "]"
+          << " [partial update: " << (setDamageRegion_ != nullptr) << "]"
+          << " [swap with damage: " << (swapWithDamage_ != nullptr) << "]"
+          << std::endl;
+}
+
+void DamageTracker::resize(EGLint width, EGLint height) {
+    width_ = width;
+    height_ = height;
+    historyCount_ = 0;
+    invalidate();
+}
+
+void DamageTracker::invalidate() {
+    full_ = true;
+}
+
+void DamageTracker::add(const DamageRect &rect) {
+    auto left = std::max(rect.x, 0);
+    auto bottom = std::max(rect.y, 0);
+    auto right = std::min(rect.x + rect.width, width_);
+    auto top = std::min(rect.y + rect.height, height_);
+    DamageRect clipped{left, bottom, right - left, top - bottom};
+    if (clipped.isEmpty()) return;
+
+    if (current_.count < kMaxRects) {
+        current_.rects[current_.count++] = clipped;
+    } else {
+        auto &last = current_.rects[kMaxRects - 1];
+        last = last.united(clipped);
+    }
+}
+
+DamageRect DamageTracker::beginFrame() {
+    if (full_) {
+        current_.rects[0] = _surfaceRect();
+        current_.count = 1;
+    }
+
+    // age 为0表示缓冲内容未定义, 超过历史长度的也只能整帧重画
+    EGLint age = 0;
+    if (bufferAge_) {
+        eglQuerySurface(display_, surface_, EGL_BUFFER_AGE_EXT, &age);
+    }
+    auto repaint = current_.bounds();
+    if (age <= 0 || age - 1 > historyCount_) {
+        repaint = _surfaceRect();
+    } else {
+        for (int i = 0; i < age - 1; ++i) {
+            repaint = repaint.united(history_[i].bounds());
+        }
+    }
+
+    if (setDamageRegion_) {
+        auto region = nonEmpty(repaint);
+        setDamageRegion_(display_, surface_, &region.x, 1);
+    }
+    return repaint;
+}
+
+DamageRect DamageTracker::frameBounds() const {
+    return current_.bounds();
+}
+
+EGLBoolean DamageTracker::swap() {
+    EGLBoolean result;
+    if (swapWithDamage_) {
+        DamageRect rects[kMaxRects];
+        auto count = std::max(current_.count, 1);
+        rects[0] = nonEmpty(current_.count ? current_.rects[0] : DamageRect{0, 0, 0, 0});
+        for (int i = 1; i < count; ++i) {
+            rects[i] = current_.rects[i];
+        }
+        static_assert(sizeof(DamageRect) == 4 * sizeof(EGLint), "passed as x, y, w, h arrays");
+        result = swapWithDamage_(display_, surface_, &rects[0].x, count);
+    } else {
+        result = eglSwapBuffers(display_, surface_);
+    }
+    GL_TRACE_FRAME(width_, height_);
+
+    for (int i = kHistory - 1; i > 0; --i) {
+        history_[i] = history_[i - 1];
+    }
+    history_[0] = current_;
+    historyCount_ = std::min(historyCount_ + 1, kHistory);
+    current_.count = 0;
+    full_ = false;
+    return result;
+}
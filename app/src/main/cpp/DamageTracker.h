@@ -0,0 +1,97 @@
+#ifndef EGL_LEARNING_DAMAGETRACKER_H
+#define EGL_LEARNING_DAMAGETRACKER_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/*!
+ * Pixel rectangle with the bottom-left origin shared by glScissor and the EGL damage extensions
+ */
+struct DamageRect {
+    EGLint x, y, width, height;
+
+    inline bool isEmpty() const { return width <= 0 || height <= 0; }
+
+    DamageRect united(const DamageRect &o) const;
+};
+
+/*!
+ * Tracks which pixels changed per frame so a frame only repaints those.
+ *
+ * With EGL_EXT_buffer_age (or EGL_KHR_partial_update) the back buffer still holds the frame
+ * drawn `age` swaps ago, so it is enough to repaint this frame's damage plus the damage of the
+ * frames in between. @a beginFrame() returns that region for the scissor and, when
+ * EGL_KHR_partial_update is present, declares it to the driver so tiles outside it are neither
+ * loaded nor stored. @a swap() passes this frame's damage to the compositor through
+ * eglSwapBuffersWithDamageKHR/EXT. Without buffer age every frame repaints in full.
+ *
+ * Per frame: any number of @a add(), @a beginFrame(), draws limited to the region, @a swap().
+ */
+class DamageTracker {
+public:
+    //! frames of history kept, older back buffers are repainted in full
+    static constexpr int kHistory = 4;
+    //! rectangles kept per frame, further ones are merged into the last
+    static constexpr int kMaxRects = 4;
+
+    DamageTracker();
+
+    /*!
+     * Detects the extensions and loads their entry points, call once the surface exists
+     */
+    void init(EGLDisplay display, EGLSurface surface);
+
+    //! new surface size, forces a full repaint
+    void resize(EGLint width, EGLint height);
+
+    //! forces a full repaint of the next frame, e.g. after a state change that touches every pixel
+    void invalidate();
+
+    //! marks @a rect as changed this frame, clipped to the surface
+    void add(const DamageRect &rect);
+
+    /*!
+     * Call after the last @a add() and before the first draw to the surface.
+     * @return the bounding box of the region that must be repainted into the back buffer
+     */
+    DamageRect beginFrame();
+
+    //! bounding box of this frame's own damage, what changed since the previous frame
+    DamageRect frameBounds() const;
+
+    /*!
+     * Presents the frame, with its damage when the driver accepts it, and moves this frame's
+     * damage into the history
+     */
+    EGLBoolean swap();
+
+    inline bool bufferAgeSupported() const { return bufferAge_; }
+
+private:
+    struct Region {
+        DamageRect rects[kMaxRects];
+        int count;
+
+        DamageRect bounds() const;
+    };
+
+    EGLDisplay display_;
+    EGLSurface surface_;
+    EGLint width_;
+    EGLint height_;
+    bool bufferAge_;
+    PFNEGLSETDAMAGEREGIONKHRPROC setDamageRegion_;
+    //! the KHR and EXT variants share one signature
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swapWithDamage_;
+
+    bool full_;
+    Region current_;
+    //! history_[0] is the previous frame
+    Region history_[kHistory];
+    int historyCount_;
+
+    inline DamageRect _surfaceRect() const { return {0, 0, width_, height_}; }
+};
+
+
+#endif //EGL_LEARNING_DAMAGETRACKER_H
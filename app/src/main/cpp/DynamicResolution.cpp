@@ -0,0 +1,201 @@
+#include "DynamicResolution.h"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "AndroidOut.h"
+
+ResolutionController::ResolutionController(const ResolutionSettings &settings)
+        : settings_(settings),
+          scale_(settings.maxScale),
+          smoothed_(0),
+          spareFrames_(0),
+          settle_(0) {}
+
+float ResolutionController::update(float gpuTime, float cpuTime) {
+    if (gpuTime <= 0) {
+        // 没有GPU计时就无从判断像素开销, 保持当前比例
+        return scale_;
+    }
+    smoothed_ = smoothed_ > 0
+                ? smoothed_ + (gpuTime - smoothed_) * settings_.smoothing
+                : gpuTime;
+    if (settle_ > 0) {
+        --settle_;
+        return scale_;
+    }
+
+    auto target = settings_.targetFrameTime;
+    if (smoothed_ > target) {
+        // 像素开销和缩放比例的平方成正比, 一步降到刚好满足目标的比例
+        auto scale = std::max(settings_.minScale, scale_ * std::sqrt(target / smoothed_));
+        spareFrames_ = 0;
+        if (scale < scale_) {
+            scale_ = scale;
+            smoothed_ = target;
+            settle_ = settings_.settleFrames;
+        }
+    } else if (smoothed_ < target * (1 - settings_.headroom) && cpuTime <= target) {
+        // 有余量时要连续保持一段时间才慢慢升高
+        if (++spareFrames_ >= settings_.raiseDelay && scale_ < settings_.maxScale) {
+            scale_ = std::min(settings_.maxScale, scale_ + settings_.raiseStep);
+            spareFrames_ = 0;
+            settle_ = settings_.settleFrames;
+        }
+    } else {
+        // GPU没有余量或CPU已经超时都不升高
+        spareFrames_ = 0;
+    }
+    return scale_;
+}
+
+bool ResolutionController::setBounds(float minScale, float maxScale) {
+    // 和 NaN 的比较都为假, NaN 也会被拒绝
+    auto valid = minScale > 0 && minScale <= maxScale && maxScale <= 1;
+    if (!valid) {
+        warn << "invalid resolution bounds " << minScale << ", " << maxScale << std::endl;
+        return false;
+    }
+    settings_.minScale = minScale;
+    settings_.maxScale = maxScale;
+    scale_ = std::min(std::max(scale_, minScale), maxScale);
+    return true;
+}
+
+GpuTimer::GpuTimer()
+        : supported_(false),
+          queries_{},
+          pending_{},
+          next_(0),
+          oldest_(0),
+          latest_(0) {
+    auto extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    supported_ = extensions && std::strstr(extensions, "GL_EXT_disjoint_timer_query");
+    if (supported_) {
+        glGenQueries(kQueries, queries_);
+    } else {
+        debug << "GPU timer unavailable, resolution scale stays fixed" << std::endl;
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    if (supported_) {
+        glDeleteQueries(kQueries, queries_);
+    }
+}
+
+void GpuTimer::begin() {
+    if (!supported_) return;
+    if (pending_[next_]) {
+        // 结果一直没取到, 放弃最旧的那一次
+        pending_[next_] = false;
+        oldest_ = (next_ + 1) % kQueries;
+    }
+    glBeginQuery(GL_TIME_ELAPSED_EXT, queries_[next_]);
+}
+
+void GpuTimer::end() {
+    if (!supported_) return;
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    pending_[next_] = true;
+    next_ = (next_ + 1) % kQueries;
+}
+
+float GpuTimer::poll() {
+    if (!supported_) return 0;
+
+    while (pending_[oldest_]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries_[oldest_], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint elapsed = 0;
+        glGetQueryObjectuiv(queries_[oldest_], GL_QUERY_RESULT, &elapsed);
+        pending_[oldest_] = false;
+        oldest_ = (oldest_ + 1) % kQueries;
+
+        // 期间发生过频率切换等情况时结果不可信
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (!disjoint) {
+            latest_ = elapsed * 1e-9f;
+        }
+    }
+    return latest_;
+}
+
+ScaledFramebuffer::ScaledFramebuffer()
+        : framebuffer_(0),
+          color_(0),
+          depth_(0),
+          width_(0),
+          height_(0),
+          maxScale_(1),
+          renderWidth_(0),
+          renderHeight_(0) {
+    glGenFramebuffers(1, &framebuffer_);
+    glGenRenderbuffers(1, &color_);
+    glGenRenderbuffers(1, &depth_);
+}
+
+ScaledFramebuffer::~ScaledFramebuffer() {
+    glDeleteRenderbuffers(1, &depth_);
+    glDeleteRenderbuffers(1, &color_);
+    glDeleteFramebuffers(1, &framebuffer_);
+}
+
+bool ScaledFramebuffer::resize(GLint width, GLint height, float maxScale) {
+    width_ = width;
+    height_ = height;
+    maxScale_ = maxScale;
+    auto allocatedWidth = std::max(1, static_cast<GLint>(std::ceil(width * maxScale)));
+    auto allocatedHeight = std::max(1, static_cast<GLint>(std::ceil(height * maxScale)));
+
+    // 只需要被blit读取, 不需要采样, 用renderbuffer就够了
+    glBindRenderbuffer(GL_RENDERBUFFER, color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, allocatedWidth, allocatedHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, allocatedWidth, allocatedHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_);
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        warn << "scaled framebuffer incomplete: " << status << std::endl;
+        return false;
+    }
+    debug << "scaled framebuffer " << allocatedWidth << "x" << allocatedHeight
+          << " for surface " << width << "x" << height << std::endl;
+    return true;
+}
+
+void ScaledFramebuffer::bind(float scale) {
+    scale = std::min(scale, maxScale_);
+    renderWidth_ = std::max(1, static_cast<GLint>(width_ * scale));
+    renderHeight_ = std::max(1, static_cast<GLint>(height_ * scale));
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, renderWidth_, renderHeight_);
+}
+
+void ScaledFramebuffer::present() {
+    // 深度不需要保留, 告诉驱动不必写回内存
+    const GLenum discard[] = {GL_DEPTH_ATTACHMENT};
+    glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, discard);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(
+            0, 0, renderWidth_, renderHeight_,
+            0, 0, width_, height_,
+            GL_COLOR_BUFFER_BIT,
+            GL_LINEAR
+    );
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width_, height_);
+}
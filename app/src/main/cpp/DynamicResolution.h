@@ -0,0 +1,152 @@
+#ifndef EGL_LEARNING_DYNAMICRESOLUTION_H
+#define EGL_LEARNING_DYNAMICRESOLUTION_H
+
+#include <GLES3/gl3.h>
+#include "GlTrace.h"
+
+/*!
+ * Tuning for @a ResolutionController
+ */
+struct ResolutionSettings {
+    //! seconds per frame the controller aims for
+    float targetFrameTime = 1 / 60.f;
+    float minScale = .5f;
+    float maxScale = 1.f;
+    //! frame time fraction below the target that counts as spare time
+    float headroom = .15f;
+    //! weight of the newest sample in the smoothed frame time
+    float smoothing = .2f;
+    //! consecutive frames with spare time before the scale goes up one step
+    int raiseDelay = 30;
+    float raiseStep = .05f;
+    //! frames to ignore after a change, the GPU timings lag a few frames behind
+    int settleFrames = 4;
+};
+
+/*!
+ * Picks the render scale from measured GPU frame times, with hysteresis: a frame that runs over
+ * the target lowers the scale right away, by the amount that would bring the pixel cost back to
+ * the target, while spare time raises it one small step at a time and only after it has held for
+ * @a ResolutionSettings::raiseDelay frames. The asymmetry keeps it from oscillating around the
+ * boundary as the device heats up and throttles.
+ *
+ * Only the GPU time depends on the scale, so only it can lower the scale. A CPU bound frame
+ * holds the scale where it is instead: fewer pixels would not make it any faster.
+ */
+class ResolutionController {
+public:
+    explicit ResolutionController(const ResolutionSettings &settings = {});
+
+    /*!
+     * @param gpuTime seconds the GPU spent on a recent frame, 0 if there is no measurement
+     * @param cpuTime seconds the CPU spent on the last frame
+     * @return the scale for the next frame
+     */
+    float update(float gpuTime, float cpuTime);
+
+    inline float scale() const { return scale_; }
+
+    /*!
+     * Clamps the current scale into the new bounds. They must satisfy
+     * 0 < @a minScale <= @a maxScale <= 1.
+     * @return false and logs a warning if they do not, the old bounds stay in place then
+     */
+    bool setBounds(float minScale, float maxScale);
+
+    inline const ResolutionSettings &settings() const { return settings_; }
+
+private:
+    ResolutionSettings settings_;
+    float scale_;
+    float smoothed_;
+    int spareFrames_;
+    int settle_;
+};
+
+/*!
+ * GPU time per frame through EXT_disjoint_timer_query, using the core ES 3 query entry points.
+ * Results are read a few frames late without waiting; frames the driver flags as disjoint are
+ * dropped.
+ */
+class GpuTimer {
+public:
+    static constexpr int kQueries = 4;
+
+    GpuTimer();
+
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer &) = delete;
+
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    //! false when the extension is missing, then every call is a no-op
+    inline bool supported() const { return supported_; }
+
+    void begin();
+
+    void end();
+
+    /*!
+     * @return the newest finished measurement in seconds, or 0 if there is none yet
+     */
+    float poll();
+
+private:
+    bool supported_;
+    GLuint queries_[kQueries];
+    bool pending_[kQueries];
+    int next_;
+    int oldest_;
+    float latest_;
+};
+
+/*!
+ * Offscreen color + depth target allocated at the maximum scale of the surface. Each frame
+ * renders into its scaled bottom-left corner and @a present() upscales that corner to the
+ * default framebuffer with a bilinear blit.
+ */
+class ScaledFramebuffer {
+public:
+    ScaledFramebuffer();
+
+    ~ScaledFramebuffer();
+
+    ScaledFramebuffer(const ScaledFramebuffer &) = delete;
+
+    ScaledFramebuffer &operator=(const ScaledFramebuffer &) = delete;
+
+    /*!
+     * (Re)allocates the attachments for a surface of @a width x @a height at @a maxScale
+     * @return false if the framebuffer is incomplete
+     */
+    bool resize(GLint width, GLint height, float maxScale);
+
+    /*!
+     * Binds the framebuffer and sets the viewport to @a scale of the surface
+     */
+    void bind(float scale);
+
+    /*!
+     * Upscales the area rendered since @a bind() to the whole default framebuffer and leaves the
+     * default framebuffer bound for reading and drawing
+     */
+    void present();
+
+    inline GLint renderWidth() const { return renderWidth_; }
+
+    inline GLint renderHeight() const { return renderHeight_; }
+
+private:
+    GLuint framebuffer_;
+    GLuint color_;
+    GLuint depth_;
+    GLint width_;
+    GLint height_;
+    float maxScale_;
+    GLint renderWidth_;
+    GLint renderHeight_;
+};
+
+
+#endif //EGL_LEARNING_DYNAMICRESOLUTION_H
@@ -0,0 +1,73 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+#include "AndroidOut.h"
+#include "HeapGuard.h"
+
+FrameArena::FrameArena(size_t capacity)
+        : capacity_(capacity),
+          halves_{},
+          current_(0),
+          highWater_(0),
+          reported_(0) {
+    for (auto &half: halves_) {
+        half.memory = std::make_unique<uint8_t[]>(capacity);
+    }
+}
+
+FrameArena::~FrameArena() {
+    for (auto &half: halves_) {
+        _reset(half);
+    }
+}
+
+void FrameArena::beginFrame() {
+    highWater_ = std::max(highWater_, halves_[current_].used);
+    // 峰值每涨过容量的1/16才记一次, 稳定后不再刷屏
+    if (highWater_ > reported_ + capacity_ / 16 || (highWater_ > capacity_ && highWater_ > reported_)) {
+        reported_ = highWater_;
+        debug << "frame arena high water " << highWater_ << " of " << capacity_ << " bytes" << std::endl;
+    }
+
+    current_ ^= 1;
+    _reset(halves_[current_]);
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+    auto &half = halves_[current_];
+    auto base = reinterpret_cast<uintptr_t>(half.memory.get());
+    auto start = (base + half.offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    auto end = start - base + size;
+    if (end > capacity_) {
+        return _allocateOverflow(half, size, alignment);
+    }
+    half.used += end - half.offset;
+    half.offset = end;
+    return reinterpret_cast<void *>(start);
+}
+
+void *FrameArena::_allocateOverflow(Half &half, size_t size, size_t alignment) {
+    if (!half.overflow) {
+        warn << "frame arena overflow, capacity " << capacity_ << " bytes" << std::endl;
+    }
+    // 块头占一个对齐单位, 数据紧跟在后面
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    static_assert(sizeof(Overflow) <= alignof(std::max_align_t), "header fits one alignment unit");
+    // 溢出是容量设小了, 由上面的警告和峰值记录报告, 堆检查不应把它当成意外分配
+    HEAP_GUARD_ALLOW();
+    auto block = static_cast<uint8_t *>(::operator new(alignment + size, std::align_val_t(alignment)));
+    half.overflow = new(block) Overflow{half.overflow, alignment};
+    half.used += size;
+    return block + alignment;
+}
+
+void FrameArena::_reset(Half &half) {
+    while (half.overflow) {
+        auto block = half.overflow;
+        half.overflow = block->next;
+        ::operator delete(block, std::align_val_t(block->alignment));
+    }
+    half.offset = 0;
+    half.used = 0;
+}
@@ -0,0 +1,128 @@
+#ifndef EGL_LEARNING_FRAMEARENA_H
+#define EGL_LEARNING_FRAMEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*!
+ * Bump allocator for data that lives for a frame, such as draw lists.
+ *
+ * Memory comes from two fixed halves used on alternate frames. @a beginFrame() switches halves
+ * and releases everything allocated in the new one two frames ago at once; individual frees do
+ * nothing. A frame's output therefore stays valid through the next frame, long enough to hand it
+ * to whoever consumes it while the next one is being built.
+ *
+ * Not thread safe, allocate from one thread (the GL thread).
+ */
+class FrameArena {
+public:
+    //! @param capacity bytes per half
+    explicit FrameArena(size_t capacity);
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    ~FrameArena();
+
+    void beginFrame();
+
+    /*!
+     * Never fails. Past the capacity it falls back to the heap, released with the half, and
+     * warns; the overflow counts towards @a highWater() so the log shows the size needed. The
+     * fallback lifts @a HEAP_GUARD(), so an undersized arena is reported rather than fatal.
+     */
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    inline size_t capacity() const { return capacity_; }
+
+    //! bytes allocated in the current frame so far
+    inline size_t used() const { return halves_[current_].used; }
+
+    //! bytes the previous frame ended with
+    inline size_t lastFrameUsed() const { return halves_[current_ ^ 1].used; }
+
+    //! the most any frame has used
+    inline size_t highWater() const { return highWater_; }
+
+private:
+    //! header of a heap block taken past the capacity
+    struct Overflow {
+        Overflow *next;
+        size_t alignment;
+    };
+
+    struct Half {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t offset;
+        //! offset plus overflow bytes
+        size_t used;
+        Overflow *overflow;
+    };
+
+    void *_allocateOverflow(Half &half, size_t size, size_t alignment);
+
+    static void _reset(Half &half);
+
+    size_t capacity_;
+    Half halves_[2];
+    int current_;
+    size_t highWater_;
+    //! high water last written to the log
+    size_t reported_;
+};
+
+/*!
+ * STL allocator over a @a FrameArena, for containers built and dropped within a frame or two.
+ * Converts implicitly from the arena, so `ArenaVector<int> list(arena);` works.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator(FrameArena &arena) : arena_(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena_) {}
+
+    inline T *allocate(size_t count) {
+        return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    //! released all at once by @a FrameArena::beginFrame()
+    inline void deallocate(T *, size_t) {}
+
+    //! resize() default initializes instead of zeroing, the contents get overwritten anyway
+    template<typename U>
+    inline void construct(U *pointer) {
+        ::new(static_cast<void *>(pointer)) U;
+    }
+
+    template<typename U, typename... Args>
+    inline void construct(U *pointer, Args &&... args) {
+        ::new(static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    inline bool operator==(const ArenaAllocator<U> &other) const { return arena_ == other.arena_; }
+
+    template<typename U>
+    inline bool operator!=(const ArenaAllocator<U> &other) const { return arena_ != other.arena_; }
+
+private:
+    template<typename U>
+    friend class ArenaAllocator;
+
+    FrameArena *arena_;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+
+#endif //EGL_LEARNING_FRAMEARENA_H
@@ -0,0 +1,193 @@
+#include "FrameCapture.h"
+
+#include <android/bitmap.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "AndroidOut.h"
+#include "HeapGuard.h"
+
+namespace {
+    //! owned by the background job, deleted once the consumer returns
+    struct CaptureTask {
+        CapturedFrame frame;
+        CaptureConsumer consumer;
+    };
+
+    void runCaptureTask(void *data, size_t, size_t) {
+        auto task = static_cast<CaptureTask *>(data);
+        task->consumer(task->frame);
+        delete task;
+    }
+
+    bool writeToFile(void *userContext, const void *data, size_t size) {
+        return std::fwrite(data, 1, size, static_cast<FILE *>(userContext)) == size;
+    }
+}
+
+FrameCapture::FrameCapture(JobSystem &jobs)
+        : jobs_(jobs),
+          slots_{},
+          next_(0),
+          frame_(0) {
+    GLuint buffers[kBuffers];
+    glGenBuffers(kBuffers, buffers);
+    for (int i = 0; i < kBuffers; ++i) {
+        slots_[i].buffer = buffers[i];
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    // 还没完成的读回直接丢弃
+    for (auto &slot: slots_) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+void FrameCapture::request(CaptureConsumer consumer) {
+    requests_.push_back(std::move(consumer));
+}
+
+void FrameCapture::startContinuous(CaptureConsumer consumer) {
+    continuous_ = std::move(consumer);
+}
+
+void FrameCapture::stopContinuous() {
+    continuous_ = nullptr;
+}
+
+void FrameCapture::capture(GLint width, GLint height) {
+    auto frame = frame_++;
+    if (requests_.empty() && !continuous_) return;
+
+    auto &slot = slots_[next_];
+    if (slot.fence) {
+        // 所有缓冲都还在等GPU, 跳过这一帧而不是阻塞
+        warn << "frame capture skipped frame " << frame << ", all buffers in flight" << std::endl;
+        return;
+    }
+    next_ = (next_ + 1) % kBuffers;
+
+    // 只有请求了读回的帧才会走到这里, 复制回调允许分配
+    HEAP_GUARD_ALLOW();
+    if (!requests_.empty()) {
+        slot.consumer = std::move(requests_.front());
+        requests_.erase(requests_.begin());
+    } else {
+        slot.consumer = continuous_;
+    }
+    slot.width = width;
+    slot.height = height;
+    slot.frame = frame;
+
+    // 绑定了PACK缓冲后 glReadPixels 只是排队一次GPU拷贝, 立即返回
+    auto size = static_cast<GLsizeiptr>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FrameCapture::poll() {
+    // 按提交顺序检查, 这样消费者收到的帧也是有序的
+    for (int i = 0; i < kBuffers; ++i) {
+        auto &slot = slots_[(next_ + i) % kBuffers];
+        if (!slot.fence) continue;
+
+        GLint status = GL_UNSIGNALED;
+        glGetSynciv(slot.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+        if (status != GL_SIGNALED) break;
+
+        _finish(slot);
+    }
+}
+
+void FrameCapture::_finish(Slot &slot) {
+    HEAP_GUARD_ALLOW();
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    auto task = new CaptureTask{{slot.width, slot.height, slot.frame, {}}, std::move(slot.consumer)};
+    slot.consumer = nullptr;
+
+    auto size = static_cast<GLsizeiptr>(slot.width) * slot.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    auto mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (!mapped) {
+        warn << "frame capture map failure" << std::endl;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        delete task;
+        return;
+    }
+    // 拷贝出来后立即归还缓冲, 编码在工作线程上进行
+    auto bytes = static_cast<const uint8_t *>(mapped);
+    task->frame.pixels.assign(bytes, bytes + size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    jobs_.runBackground(runCaptureTask, task);
+}
+
+bool FrameCapture::writePng(const CapturedFrame &frame, const std::string &path) {
+    // PNG从最上面一行开始, 读回的数据从最下面一行开始
+    auto stride = static_cast<size_t>(frame.width) * 4;
+    std::vector<uint8_t> flipped(frame.pixels.size());
+    flipRows(frame.pixels.data(), flipped.data(), stride, frame.height);
+
+    auto file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        warn << "capture open failure, path: " << path << std::endl;
+        return false;
+    }
+
+    AndroidBitmapInfo info{};
+    info.width = frame.width;
+    info.height = frame.height;
+    info.stride = stride;
+    info.format = ANDROID_BITMAP_FORMAT_RGBA_8888;
+    info.flags = ANDROID_BITMAP_FLAGS_ALPHA_PREMUL;
+    auto result = AndroidBitmap_compress(
+            &info,
+            ADATASPACE_SRGB,
+            flipped.data(),
+            ANDROID_BITMAP_COMPRESS_FORMAT_PNG,
+            100,
+            file,
+            writeToFile
+    );
+    auto closed = std::fclose(file) == 0;
+
+    if (result != ANDROID_BITMAP_RESULT_SUCCESS || !closed) {
+        warn << "capture encode failure, path: " << path << std::endl;
+        return false;
+    }
+    debug << "captured frame " << frame.frame << " to " << path << std::endl;
+    return true;
+}
+
+int64_t FrameCapture::compare(const CapturedFrame &frame, const ImageData &golden, int tolerance) {
+    if (frame.width != golden.width || frame.height != golden.height) {
+        return -1;
+    }
+
+    int64_t mismatches = 0;
+    auto stride = static_cast<size_t>(frame.width) * 4;
+    for (int32_t row = 0; row < frame.height; ++row) {
+        auto actual = frame.pixels.data() + row * stride;
+        auto expected = golden.pixels.data() + row * golden.stride;
+        for (int32_t column = 0; column < frame.width; ++column) {
+            for (int channel = 0; channel < 4; ++channel) {
+                auto index = column * 4 + channel;
+                if (std::abs(actual[index] - expected[index]) > tolerance) {
+                    ++mismatches;
+                    break;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
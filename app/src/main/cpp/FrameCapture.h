@@ -0,0 +1,107 @@
+#ifndef EGL_LEARNING_FRAMECAPTURE_H
+#define EGL_LEARNING_FRAMECAPTURE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <GLES3/gl3.h>
+#include "GlTrace.h"
+#include "Image.h"
+#include "JobSystem.h"
+
+/*!
+ * One read back frame: tightly packed RGBA rows, bottom row first like glReadPixels returns them
+ * (and like @a ImageData, so golden images compare row for row)
+ */
+struct CapturedFrame {
+    int32_t width;
+    int32_t height;
+    //! index of the captured frame, counted by @a FrameCapture::capture()
+    uint64_t frame;
+    std::vector<uint8_t> pixels;
+};
+
+/*!
+ * Runs on a job system worker once the pixels are on the CPU
+ */
+typedef std::function<void(const CapturedFrame &frame)> CaptureConsumer;
+
+/*!
+ * Asynchronous framebuffer readback.
+ *
+ * @a capture() only issues glReadPixels into the next GL_PIXEL_PACK_BUFFER of a small ring and
+ * fences it, so the copy happens on the GPU timeline. @a poll() checks the fences without waiting
+ * and maps a buffer only once its fence has signalled, copies the pixels out and hands them to
+ * the request's consumer through @a JobSystem::runBackground(), so encoding never blocks a frame.
+ * When every buffer is still in flight the capture is skipped rather than stalling the pipeline.
+ */
+class FrameCapture {
+public:
+    static constexpr int kBuffers = 3;
+
+    explicit FrameCapture(JobSystem &jobs);
+
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture &) = delete;
+
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    /*!
+     * Captures the next frame passed to @a capture(). Requests queue up, one frame each.
+     */
+    void request(CaptureConsumer consumer);
+
+    /*!
+     * Captures every frame until @a stopContinuous(), e.g. for recording video
+     */
+    void startContinuous(CaptureConsumer consumer);
+
+    void stopContinuous();
+
+    /*!
+     * Reads back the bound read framebuffer if a capture is pending. Call after the last draw and
+     * before eglSwapBuffers.
+     */
+    void capture(GLint width, GLint height);
+
+    /*!
+     * Hands finished readbacks to their consumers, never waits on the GPU. Call once per frame.
+     */
+    void poll();
+
+    /*!
+     * Encodes @a frame as PNG through AndroidBitmap_compress and writes it to @a path.
+     * Safe to call from a worker.
+     */
+    static bool writePng(const CapturedFrame &frame, const std::string &path);
+
+    /*!
+     * Counts the pixels whose channels differ from @a golden by more than @a tolerance.
+     * @return the count, or -1 if the sizes differ
+     */
+    static int64_t compare(const CapturedFrame &frame, const ImageData &golden, int tolerance);
+
+private:
+    struct Slot {
+        GLuint buffer;
+        GLsync fence;
+        GLint width;
+        GLint height;
+        uint64_t frame;
+        CaptureConsumer consumer;
+    };
+
+    JobSystem &jobs_;
+    Slot slots_[kBuffers];
+    int next_;
+    uint64_t frame_;
+    std::vector<CaptureConsumer> requests_;
+    CaptureConsumer continuous_;
+
+    void _finish(Slot &slot);
+};
+
+
+#endif //EGL_LEARNING_FRAMECAPTURE_H
@@ -0,0 +1,555 @@
+#if defined(EGL_GL_TRACE)
+
+#define GL_TRACE_IMPLEMENTATION
+
+#include "GlTrace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+
+#include "AndroidOut.h"
+#include "GlTraceFormat.h"
+#include "HeapGuard.h"
+
+namespace gltrace {
+
+    /*!
+     * Recorder state. Only the GL thread records, so none of it is synchronized.
+     */
+    namespace {
+        struct Mapping {
+            uint8_t *data;
+            GLsizeiptr length;
+            GLbitfield access;
+        };
+
+        //! buffered by stdio, a frame's records usually reach the file in one write
+        constexpr size_t kFileBufferSize = 1 << 20;
+
+        FILE *file = nullptr;
+        uint64_t frames = 0;
+        GLint unpackAlignment = 4;
+        /*!
+         * Keyed by buffer name, written back on unmap. Entries are made when buffers are
+         * generated, so mapping inside a heap guarded frame finds its node already there.
+         */
+        std::unordered_map<GLuint, Mapping> mappings;
+
+        inline uint64_t arg(GLint value) { return static_cast<uint64_t>(static_cast<int64_t>(value)); }
+
+        inline uint64_t arg(GLuint value) { return value; }
+
+        inline uint64_t arg(GLfloat value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof bits);
+            return bits;
+        }
+
+        inline uint64_t arg(GLintptr value) { return static_cast<uint64_t>(value); }
+
+        inline uint64_t arg(GLuint64 value) { return value; }
+
+        inline uint64_t arg(const void *pointer) { return reinterpret_cast<uintptr_t>(pointer); }
+
+        void record(
+                Call call,
+                std::initializer_list<uint64_t> args,
+                const void *payload = nullptr,
+                size_t payloadSize = 0
+        ) {
+            if (!file) return;
+            RecordHeader header{
+                    call,
+                    static_cast<uint16_t>(args.size()),
+                    static_cast<uint32_t>(payloadSize)
+            };
+            std::fwrite(&header, sizeof header, 1, file);
+            std::fwrite(args.begin(), sizeof(uint64_t), args.size(), file);
+            if (payloadSize) std::fwrite(payload, 1, payloadSize, file);
+        }
+
+        void recordNames(Call call, GLsizei n, const GLuint *names) {
+            record(call, {arg(n)}, names, n * sizeof(GLuint));
+        }
+
+        //! the binding query for a buffer target, used to key mappings by buffer
+        GLenum bindingOf(GLenum target) {
+            switch (target) {
+                case GL_ARRAY_BUFFER:
+                    return GL_ARRAY_BUFFER_BINDING;
+                case GL_ELEMENT_ARRAY_BUFFER:
+                    return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+                case GL_UNIFORM_BUFFER:
+                    return GL_UNIFORM_BUFFER_BINDING;
+                case GL_PIXEL_PACK_BUFFER:
+                    return GL_PIXEL_PACK_BUFFER_BINDING;
+                case GL_PIXEL_UNPACK_BUFFER:
+                    return GL_PIXEL_UNPACK_BUFFER_BINDING;
+                case GL_COPY_READ_BUFFER:
+                    return GL_COPY_READ_BUFFER_BINDING;
+                case GL_COPY_WRITE_BUFFER:
+                    return GL_COPY_WRITE_BUFFER_BINDING;
+                case GL_TRANSFORM_FEEDBACK_BUFFER:
+                    return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
+                default:
+                    return 0;
+            }
+        }
+
+        GLuint boundBuffer(GLenum target) {
+            GLint buffer = 0;
+            auto binding = bindingOf(target);
+            if (binding) ::glGetIntegerv(binding, &buffer);
+            return static_cast<GLuint>(buffer);
+        }
+    }
+
+    bool start(const char *path) {
+        stop();
+        file = std::fopen(path, "wb");
+        if (!file) {
+            warn << "gl trace open failure, path: " << path << std::endl;
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IOFBF, kFileBufferSize);
+        TraceHeader header{kMagic, kVersion};
+        std::fwrite(&header, sizeof header, 1, file);
+        frames = 0;
+        debug << "gl trace recording to " << path << std::endl;
+        return true;
+    }
+
+    void stop() {
+        if (!file) return;
+        std::fclose(file);
+        file = nullptr;
+        debug << "gl trace stopped after " << frames << " frames" << std::endl;
+    }
+
+    void frame(int32_t width, int32_t height) {
+        record(kFrame, {arg(width), arg(height)});
+        ++frames;
+    }
+
+    void glActiveTexture(GLenum texture) {
+        ::glActiveTexture(texture);
+        record(kActiveTexture, {arg(texture)});
+    }
+
+    void glAttachShader(GLuint program, GLuint shader) {
+        ::glAttachShader(program, shader);
+        record(kAttachShader, {arg(program), arg(shader)});
+    }
+
+    void glBeginQuery(GLenum target, GLuint id) {
+        ::glBeginQuery(target, id);
+        record(kBeginQuery, {arg(target), arg(id)});
+    }
+
+    void glBeginTransformFeedback(GLenum primitiveMode) {
+        ::glBeginTransformFeedback(primitiveMode);
+        record(kBeginTransformFeedback, {arg(primitiveMode)});
+    }
+
+    void glBindBuffer(GLenum target, GLuint buffer) {
+        ::glBindBuffer(target, buffer);
+        record(kBindBuffer, {arg(target), arg(buffer)});
+    }
+
+    void glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        ::glBindBufferBase(target, index, buffer);
+        record(kBindBufferBase, {arg(target), arg(index), arg(buffer)});
+    }
+
+    void glBindBufferRange(
+            GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+        ::glBindBufferRange(target, index, buffer, offset, size);
+        record(kBindBufferRange, {arg(target), arg(index), arg(buffer), arg(offset), arg(size)});
+    }
+
+    void glBindFramebuffer(GLenum target, GLuint framebuffer) {
+        ::glBindFramebuffer(target, framebuffer);
+        record(kBindFramebuffer, {arg(target), arg(framebuffer)});
+    }
+
+    void glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+        ::glBindRenderbuffer(target, renderbuffer);
+        record(kBindRenderbuffer, {arg(target), arg(renderbuffer)});
+    }
+
+    void glBindTexture(GLenum target, GLuint texture) {
+        ::glBindTexture(target, texture);
+        record(kBindTexture, {arg(target), arg(texture)});
+    }
+
+    void glBindVertexArray(GLuint array) {
+        ::glBindVertexArray(array);
+        record(kBindVertexArray, {arg(array)});
+    }
+
+    void glBlendFunc(GLenum sfactor, GLenum dfactor) {
+        ::glBlendFunc(sfactor, dfactor);
+        record(kBlendFunc, {arg(sfactor), arg(dfactor)});
+    }
+
+    void glBlitFramebuffer(
+            GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+            GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+            GLbitfield mask, GLenum filter) {
+        ::glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        record(kBlitFramebuffer, {arg(srcX0), arg(srcY0), arg(srcX1), arg(srcY1),
+                                  arg(dstX0), arg(dstY0), arg(dstX1), arg(dstY1),
+                                  arg(mask), arg(filter)});
+    }
+
+    void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+        ::glBufferData(target, size, data, usage);
+        record(kBufferData, {arg(target), arg(size), arg(usage)}, data, data ? size : 0);
+    }
+
+    void glClear(GLbitfield mask) {
+        ::glClear(mask);
+        record(kClear, {arg(mask)});
+    }
+
+    void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+        ::glClearColor(red, green, blue, alpha);
+        record(kClearColor, {arg(red), arg(green), arg(blue), arg(alpha)});
+    }
+
+    GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+        auto result = ::glClientWaitSync(sync, flags, timeout);
+        record(kClientWaitSync, {arg(sync), arg(flags), arg(timeout)});
+        return result;
+    }
+
+    void glCompileShader(GLuint shader) {
+        ::glCompileShader(shader);
+        record(kCompileShader, {arg(shader)});
+    }
+
+    GLuint glCreateProgram() {
+        auto program = ::glCreateProgram();
+        record(kCreateProgram, {arg(program)});
+        return program;
+    }
+
+    GLuint glCreateShader(GLenum type) {
+        auto shader = ::glCreateShader(type);
+        record(kCreateShader, {arg(type), arg(shader)});
+        return shader;
+    }
+
+    void glDeleteBuffers(GLsizei n, const GLuint *buffers) {
+        ::glDeleteBuffers(n, buffers);
+        recordNames(kDeleteBuffers, n, buffers);
+        for (GLsizei i = 0; i < n; ++i) {
+            mappings.erase(buffers[i]);
+        }
+    }
+
+    void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+        ::glDeleteFramebuffers(n, framebuffers);
+        recordNames(kDeleteFramebuffers, n, framebuffers);
+    }
+
+    void glDeleteProgram(GLuint program) {
+        ::glDeleteProgram(program);
+        record(kDeleteProgram, {arg(program)});
+    }
+
+    void glDeleteQueries(GLsizei n, const GLuint *ids) {
+        ::glDeleteQueries(n, ids);
+        recordNames(kDeleteQueries, n, ids);
+    }
+
+    void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers) {
+        ::glDeleteRenderbuffers(n, renderbuffers);
+        recordNames(kDeleteRenderbuffers, n, renderbuffers);
+    }
+
+    void glDeleteShader(GLuint shader) {
+        ::glDeleteShader(shader);
+        record(kDeleteShader, {arg(shader)});
+    }
+
+    void glDeleteSync(GLsync sync) {
+        ::glDeleteSync(sync);
+        record(kDeleteSync, {arg(sync)});
+    }
+
+    void glDeleteTextures(GLsizei n, const GLuint *textures) {
+        ::glDeleteTextures(n, textures);
+        recordNames(kDeleteTextures, n, textures);
+    }
+
+    void glDeleteVertexArrays(GLsizei n, const GLuint *arrays) {
+        ::glDeleteVertexArrays(n, arrays);
+        recordNames(kDeleteVertexArrays, n, arrays);
+    }
+
+    void glDepthFunc(GLenum func) {
+        ::glDepthFunc(func);
+        record(kDepthFunc, {arg(func)});
+    }
+
+    void glDepthMask(GLboolean flag) {
+        ::glDepthMask(flag);
+        record(kDepthMask, {arg(GLuint(flag))});
+    }
+
+    void glDisable(GLenum cap) {
+        ::glDisable(cap);
+        record(kDisable, {arg(cap)});
+    }
+
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+        ::glDrawArrays(mode, first, count);
+        record(kDrawArrays, {arg(mode), arg(first), arg(count)});
+    }
+
+    void glDrawElementsInstanced(
+            GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instanceCount) {
+        ::glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+        record(kDrawElementsInstanced,
+               {arg(mode), arg(count), arg(type), arg(indices), arg(instanceCount)});
+    }
+
+    void glEnable(GLenum cap) {
+        ::glEnable(cap);
+        record(kEnable, {arg(cap)});
+    }
+
+    void glEnableVertexAttribArray(GLuint index) {
+        ::glEnableVertexAttribArray(index);
+        record(kEnableVertexAttribArray, {arg(index)});
+    }
+
+    void glEndQuery(GLenum target) {
+        ::glEndQuery(target);
+        record(kEndQuery, {arg(target)});
+    }
+
+    void glEndTransformFeedback() {
+        ::glEndTransformFeedback();
+        record(kEndTransformFeedback, {});
+    }
+
+    GLsync glFenceSync(GLenum condition, GLbitfield flags) {
+        auto sync = ::glFenceSync(condition, flags);
+        record(kFenceSync, {arg(condition), arg(flags), arg(sync)});
+        return sync;
+    }
+
+    void glFramebufferRenderbuffer(
+            GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) {
+        ::glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+        record(kFramebufferRenderbuffer,
+               {arg(target), arg(attachment), arg(renderbufferTarget), arg(renderbuffer)});
+    }
+
+    void glGenBuffers(GLsizei n, GLuint *buffers) {
+        ::glGenBuffers(n, buffers);
+        recordNames(kGenBuffers, n, buffers);
+        if (file) {
+            HEAP_GUARD_ALLOW();
+            for (GLsizei i = 0; i < n; ++i) {
+                mappings.emplace(buffers[i], Mapping{});
+            }
+        }
+    }
+
+    void glGenFramebuffers(GLsizei n, GLuint *framebuffers) {
+        ::glGenFramebuffers(n, framebuffers);
+        recordNames(kGenFramebuffers, n, framebuffers);
+    }
+
+    void glGenQueries(GLsizei n, GLuint *ids) {
+        ::glGenQueries(n, ids);
+        recordNames(kGenQueries, n, ids);
+    }
+
+    void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers) {
+        ::glGenRenderbuffers(n, renderbuffers);
+        recordNames(kGenRenderbuffers, n, renderbuffers);
+    }
+
+    void glGenTextures(GLsizei n, GLuint *textures) {
+        ::glGenTextures(n, textures);
+        recordNames(kGenTextures, n, textures);
+    }
+
+    void glGenVertexArrays(GLsizei n, GLuint *arrays) {
+        ::glGenVertexArrays(n, arrays);
+        recordNames(kGenVertexArrays, n, arrays);
+    }
+
+    void glGenerateMipmap(GLenum target) {
+        ::glGenerateMipmap(target);
+        record(kGenerateMipmap, {arg(target)});
+    }
+
+    GLuint glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName) {
+        auto index = ::glGetUniformBlockIndex(program, uniformBlockName);
+        record(kGetUniformBlockIndex, {arg(program), arg(index)},
+               uniformBlockName, std::strlen(uniformBlockName) + 1);
+        return index;
+    }
+
+    GLint glGetUniformLocation(GLuint program, const GLchar *name) {
+        auto location = ::glGetUniformLocation(program, name);
+        record(kGetUniformLocation, {arg(program), arg(location)}, name, std::strlen(name) + 1);
+        return location;
+    }
+
+    void glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments) {
+        ::glInvalidateFramebuffer(target, numAttachments, attachments);
+        record(kInvalidateFramebuffer, {arg(target), arg(numAttachments)},
+               attachments, numAttachments * sizeof(GLenum));
+    }
+
+    void glLinkProgram(GLuint program) {
+        ::glLinkProgram(program);
+        record(kLinkProgram, {arg(program)});
+    }
+
+    void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+        auto data = ::glMapBufferRange(target, offset, length, access);
+        if (file && data) {
+            auto buffer = boundBuffer(target);
+            auto mapping = mappings.find(buffer);
+            if (mapping == mappings.end()) {
+                // 开始录制之前创建的缓冲没有预留条目
+                HEAP_GUARD_ALLOW();
+                mapping = mappings.emplace(buffer, Mapping{}).first;
+            }
+            mapping->second = {static_cast<uint8_t *>(data), length, access};
+            record(kMapBufferRange,
+                   {arg(target), arg(offset), arg(length), arg(access), arg(buffer)});
+        }
+        return data;
+    }
+
+    void glPixelStorei(GLenum pname, GLint param) {
+        ::glPixelStorei(pname, param);
+        if (pname == GL_UNPACK_ALIGNMENT && isUnpackAlignment(param)) unpackAlignment = param;
+        record(kPixelStorei, {arg(pname), arg(param)});
+    }
+
+    void glReadPixels(
+            GLint x, GLint y, GLsizei width, GLsizei height,
+            GLenum format, GLenum type, void *pixels) {
+        ::glReadPixels(x, y, width, height, format, type, pixels);
+        record(kReadPixels, {arg(x), arg(y), arg(width), arg(height),
+                             arg(format), arg(type), arg(pixels)});
+    }
+
+    void glRenderbufferStorage(
+            GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+        ::glRenderbufferStorage(target, internalformat, width, height);
+        record(kRenderbufferStorage, {arg(target), arg(internalformat), arg(width), arg(height)});
+    }
+
+    void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+        ::glScissor(x, y, width, height);
+        record(kScissor, {arg(x), arg(y), arg(width), arg(height)});
+    }
+
+    void glShaderSource(
+            GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length) {
+        ::glShaderSource(shader, count, string, length);
+        if (!file) return;
+        // 多段源码拼成一段, 回放时一次传入
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i) {
+            if (length && length[i] >= 0) {
+                source.append(string[i], length[i]);
+            } else {
+                source.append(string[i]);
+            }
+        }
+        record(kShaderSource, {arg(shader)}, source.data(), source.size());
+    }
+
+    void glTexImage2D(
+            GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+            GLint border, GLenum format, GLenum type, const void *pixels) {
+        ::glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        record(kTexImage2D, {arg(target), arg(level), arg(internalformat), arg(width),
+                             arg(height), arg(border), arg(format), arg(type)},
+               pixels, pixels ? imageSize(width, height, format, type, unpackAlignment) : 0);
+    }
+
+    void glTexParameteri(GLenum target, GLenum pname, GLint param) {
+        ::glTexParameteri(target, pname, param);
+        record(kTexParameteri, {arg(target), arg(pname), arg(param)});
+    }
+
+    void glTransformFeedbackVaryings(
+            GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode) {
+        ::glTransformFeedbackVaryings(program, count, varyings, bufferMode);
+        if (!file) return;
+        std::string names;
+        for (GLsizei i = 0; i < count; ++i) {
+            names.append(varyings[i]);
+            names.push_back('\0');
+        }
+        record(kTransformFeedbackVaryings, {arg(program), arg(count), arg(bufferMode)},
+               names.data(), names.size());
+    }
+
+    void glUniform1i(GLint location, GLint v0) {
+        ::glUniform1i(location, v0);
+        record(kUniform1i, {arg(location), arg(v0)});
+    }
+
+    void glUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint blockBinding) {
+        ::glUniformBlockBinding(program, blockIndex, blockBinding);
+        record(kUniformBlockBinding, {arg(program), arg(blockIndex), arg(blockBinding)});
+    }
+
+    GLboolean glUnmapBuffer(GLenum target) {
+        if (file) {
+            // 应用写入映射内存的内容在解除映射时才算数, 这时整段记录下来
+            auto buffer = boundBuffer(target);
+            auto mapping = mappings.find(buffer);
+            if (mapping != mappings.end() && mapping->second.data) {
+                auto &map = mapping->second;
+                auto written = (map.access & GL_MAP_WRITE_BIT) != 0;
+                record(kUnmapBuffer, {arg(target), arg(buffer)},
+                       map.data, written ? map.length : 0);
+                // 条目留着下次映射复用, 避免每帧分配哈希节点
+                map.data = nullptr;
+            }
+        }
+        return ::glUnmapBuffer(target);
+    }
+
+    void glUseProgram(GLuint program) {
+        ::glUseProgram(program);
+        record(kUseProgram, {arg(program)});
+    }
+
+    void glVertexAttribDivisor(GLuint index, GLuint divisor) {
+        ::glVertexAttribDivisor(index, divisor);
+        record(kVertexAttribDivisor, {arg(index), arg(divisor)});
+    }
+
+    void glVertexAttribPointer(
+            GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+            const void *pointer) {
+        ::glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        record(kVertexAttribPointer, {arg(index), arg(size), arg(type), arg(GLuint(normalized)),
+                                      arg(stride), arg(pointer)});
+    }
+
+    void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        ::glViewport(x, y, width, height);
+        record(kViewport, {arg(x), arg(y), arg(width), arg(height)});
+    }
+}
+
+#endif
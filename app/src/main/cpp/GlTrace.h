@@ -0,0 +1,200 @@
+#ifndef EGL_LEARNING_GLTRACE_H
+#define EGL_LEARNING_GLTRACE_H
+
+#include <cstdint>
+#include <GLES3/gl3.h>
+
+/*!
+ * Optional GL call recorder, compiled in with the EGL_GL_TRACE CMake option.
+ *
+ * Every source file that issues GL calls includes this header after the GL headers. With the
+ * option on, the state changing GL entry points below are redefined as macros that forward to
+ * wrappers in @a gltrace, which call the driver and append the call, its arguments and any
+ * client memory it reads to the trace file (see GlTraceFormat.h). Queries such as glGet* are
+ * not recorded, they do not change what a replay draws. A state changing call missing from
+ * this list is not recorded either, so add it here and to GL_TRACE_CALLS before using it.
+ *
+ * Without the option the header only defines @a GL_TRACE_FRAME() as a no-op and the wrappers
+ * do not exist. Replay traces with tools/glreplay.
+ */
+#if defined(EGL_GL_TRACE)
+
+namespace gltrace {
+
+    /*!
+     * Starts recording into @a path, must run on the GL thread before the first GL call.
+     * @return false if the file could not be created
+     */
+    bool start(const char *path);
+
+    //! flushes and closes the trace
+    void stop();
+
+    //! marks the end of a frame, call right after the swap
+    void frame(int32_t width, int32_t height);
+
+    void glActiveTexture(GLenum texture);
+    void glAttachShader(GLuint program, GLuint shader);
+    void glBeginQuery(GLenum target, GLuint id);
+    void glBeginTransformFeedback(GLenum primitiveMode);
+    void glBindBuffer(GLenum target, GLuint buffer);
+    void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void glBindBufferRange(
+            GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void glBindFramebuffer(GLenum target, GLuint framebuffer);
+    void glBindRenderbuffer(GLenum target, GLuint renderbuffer);
+    void glBindTexture(GLenum target, GLuint texture);
+    void glBindVertexArray(GLuint array);
+    void glBlendFunc(GLenum sfactor, GLenum dfactor);
+    void glBlitFramebuffer(
+            GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+            GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+            GLbitfield mask, GLenum filter);
+    void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+    void glClear(GLbitfield mask);
+    void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+    void glCompileShader(GLuint shader);
+    GLuint glCreateProgram();
+    GLuint glCreateShader(GLenum type);
+    void glDeleteBuffers(GLsizei n, const GLuint *buffers);
+    void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+    void glDeleteProgram(GLuint program);
+    void glDeleteQueries(GLsizei n, const GLuint *ids);
+    void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers);
+    void glDeleteShader(GLuint shader);
+    void glDeleteSync(GLsync sync);
+    void glDeleteTextures(GLsizei n, const GLuint *textures);
+    void glDeleteVertexArrays(GLsizei n, const GLuint *arrays);
+    void glDepthFunc(GLenum func);
+    void glDepthMask(GLboolean flag);
+    void glDisable(GLenum cap);
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+    void glDrawElementsInstanced(
+            GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instanceCount);
+    void glEnable(GLenum cap);
+    void glEnableVertexAttribArray(GLuint index);
+    void glEndQuery(GLenum target);
+    void glEndTransformFeedback();
+    GLsync glFenceSync(GLenum condition, GLbitfield flags);
+    void glFramebufferRenderbuffer(
+            GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer);
+    void glGenBuffers(GLsizei n, GLuint *buffers);
+    void glGenFramebuffers(GLsizei n, GLuint *framebuffers);
+    void glGenQueries(GLsizei n, GLuint *ids);
+    void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers);
+    void glGenTextures(GLsizei n, GLuint *textures);
+    void glGenVertexArrays(GLsizei n, GLuint *arrays);
+    void glGenerateMipmap(GLenum target);
+    GLuint glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName);
+    GLint glGetUniformLocation(GLuint program, const GLchar *name);
+    void glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+    void glLinkProgram(GLuint program);
+    void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    void glPixelStorei(GLenum pname, GLint param);
+    void glReadPixels(
+            GLint x, GLint y, GLsizei width, GLsizei height,
+            GLenum format, GLenum type, void *pixels);
+    void glRenderbufferStorage(
+            GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+    void glScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    void glShaderSource(
+            GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length);
+    void glTexImage2D(
+            GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+            GLint border, GLenum format, GLenum type, const void *pixels);
+    void glTexParameteri(GLenum target, GLenum pname, GLint param);
+    void glTransformFeedbackVaryings(
+            GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode);
+    void glUniform1i(GLint location, GLint v0);
+    void glUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint blockBinding);
+    GLboolean glUnmapBuffer(GLenum target);
+    void glUseProgram(GLuint program);
+    void glVertexAttribDivisor(GLuint index, GLuint divisor);
+    void glVertexAttribPointer(
+            GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+            const void *pointer);
+    void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+}
+
+#define GL_TRACE_FRAME(width, height) gltrace::frame(width, height)
+
+// GlTrace.cpp 自己要调用真正的驱动函数, 不能被重定向
+#if !defined(GL_TRACE_IMPLEMENTATION)
+#define glActiveTexture gltrace::glActiveTexture
+#define glAttachShader gltrace::glAttachShader
+#define glBeginQuery gltrace::glBeginQuery
+#define glBeginTransformFeedback gltrace::glBeginTransformFeedback
+#define glBindBuffer gltrace::glBindBuffer
+#define glBindBufferBase gltrace::glBindBufferBase
+#define glBindBufferRange gltrace::glBindBufferRange
+#define glBindFramebuffer gltrace::glBindFramebuffer
+#define glBindRenderbuffer gltrace::glBindRenderbuffer
+#define glBindTexture gltrace::glBindTexture
+#define glBindVertexArray gltrace::glBindVertexArray
+#define glBlendFunc gltrace::glBlendFunc
+#define glBlitFramebuffer gltrace::glBlitFramebuffer
+#define glBufferData gltrace::glBufferData
+#define glClear gltrace::glClear
+#define glClearColor gltrace::glClearColor
+#define glClientWaitSync gltrace::glClientWaitSync
+#define glCompileShader gltrace::glCompileShader
+#define glCreateProgram gltrace::glCreateProgram
+#define glCreateShader gltrace::glCreateShader
+#define glDeleteBuffers gltrace::glDeleteBuffers
+#define glDeleteFramebuffers gltrace::glDeleteFramebuffers
+#define glDeleteProgram gltrace::glDeleteProgram
+#define glDeleteQueries gltrace::glDeleteQueries
+#define glDeleteRenderbuffers gltrace::glDeleteRenderbuffers
+#define glDeleteShader gltrace::glDeleteShader
+#define glDeleteSync gltrace::glDeleteSync
+#define glDeleteTextures gltrace::glDeleteTextures
+#define glDeleteVertexArrays gltrace::glDeleteVertexArrays
+#define glDepthFunc gltrace::glDepthFunc
+#define glDepthMask gltrace::glDepthMask
+#define glDisable gltrace::glDisable
+#define glDrawArrays gltrace::glDrawArrays
+#define glDrawElementsInstanced gltrace::glDrawElementsInstanced
+#define glEnable gltrace::glEnable
+#define glEnableVertexAttribArray gltrace::glEnableVertexAttribArray
+#define glEndQuery gltrace::glEndQuery
+#define glEndTransformFeedback gltrace::glEndTransformFeedback
+#define glFenceSync gltrace::glFenceSync
+#define glFramebufferRenderbuffer gltrace::glFramebufferRenderbuffer
+#define glGenBuffers gltrace::glGenBuffers
+#define glGenFramebuffers gltrace::glGenFramebuffers
+#define glGenQueries gltrace::glGenQueries
+#define glGenRenderbuffers gltrace::glGenRenderbuffers
+#define glGenTextures gltrace::glGenTextures
+#define glGenVertexArrays gltrace::glGenVertexArrays
+#define glGenerateMipmap gltrace::glGenerateMipmap
+#define glGetUniformBlockIndex gltrace::glGetUniformBlockIndex
+#define glGetUniformLocation gltrace::glGetUniformLocation
+#define glInvalidateFramebuffer gltrace::glInvalidateFramebuffer
+#define glLinkProgram gltrace::glLinkProgram
+#define glMapBufferRange gltrace::glMapBufferRange
+#define glPixelStorei gltrace::glPixelStorei
+#define glReadPixels gltrace::glReadPixels
+#define glRenderbufferStorage gltrace::glRenderbufferStorage
+#define glScissor gltrace::glScissor
+#define glShaderSource gltrace::glShaderSource
+#define glTexImage2D gltrace::glTexImage2D
+#define glTexParameteri gltrace::glTexParameteri
+#define glTransformFeedbackVaryings gltrace::glTransformFeedbackVaryings
+#define glUniform1i gltrace::glUniform1i
+#define glUniformBlockBinding gltrace::glUniformBlockBinding
+#define glUnmapBuffer gltrace::glUnmapBuffer
+#define glUseProgram gltrace::glUseProgram
+#define glVertexAttribDivisor gltrace::glVertexAttribDivisor
+#define glVertexAttribPointer gltrace::glVertexAttribPointer
+#define glViewport gltrace::glViewport
+#endif
+
+#else
+
+#define GL_TRACE_FRAME(width, height)
+
+#endif
+
+
+#endif //EGL_LEARNING_GLTRACE_H
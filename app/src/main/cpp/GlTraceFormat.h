@@ -0,0 +1,196 @@
+#ifndef EGL_LEARNING_GLTRACEFORMAT_H
+#define EGL_LEARNING_GLTRACEFORMAT_H
+
+#include <cstdint>
+#include <GLES3/gl3.h>
+
+/*!
+ * Binary layout of a GL trace, shared by the recorder (GlTrace.cpp) and tools/glreplay.
+ *
+ * A trace is a @a TraceHeader followed by records up to the end of the file. Each record is a
+ * @a RecordHeader, `argCount` 64-bit arguments, then `payloadSize` bytes of payload. Integers
+ * are stored sign-extended, floats as their bit pattern, pointers that are buffer offsets as
+ * integers, and object names, uniform locations and sync handles exactly as the recording
+ * driver returned them; the replayer maps them to its own. Byte order is native, both ends
+ * are little-endian.
+ */
+namespace gltrace {
+
+    constexpr uint32_t kMagic = 0x544c4745; // "EGLT" in file order
+    constexpr uint32_t kVersion = 1;
+
+    struct TraceHeader {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct RecordHeader {
+        uint16_t call;
+        uint16_t argCount;
+        uint32_t payloadSize;
+    };
+
+    /*!
+     * Every recorded GL entry point. Arguments are stored in the GL parameter order, return
+     * values are appended after them. Payloads:
+     *  - Gen*, Delete*: the object names
+     *  - ShaderSource: the concatenated source, TransformFeedbackVaryings: NUL terminated names
+     *  - GetUniformLocation, GetUniformBlockIndex: the NUL terminated name
+     *  - BufferData: the client data, if any
+     *  - TexImage2D: the client data, if any, @a imageSize() bytes
+     *  - UnmapBuffer: the mapped range after the application wrote it, for write maps
+     *  - InvalidateFramebuffer: the attachment enums
+     * MapBufferRange and UnmapBuffer also carry the buffer bound to the target as last argument.
+     */
+#define GL_TRACE_CALLS(X) \
+    X(ActiveTexture) \
+    X(AttachShader) \
+    X(BeginQuery) \
+    X(BeginTransformFeedback) \
+    X(BindBuffer) \
+    X(BindBufferBase) \
+    X(BindBufferRange) \
+    X(BindFramebuffer) \
+    X(BindRenderbuffer) \
+    X(BindTexture) \
+    X(BindVertexArray) \
+    X(BlendFunc) \
+    X(BlitFramebuffer) \
+    X(BufferData) \
+    X(Clear) \
+    X(ClearColor) \
+    X(ClientWaitSync) \
+    X(CompileShader) \
+    X(CreateProgram) \
+    X(CreateShader) \
+    X(DeleteBuffers) \
+    X(DeleteFramebuffers) \
+    X(DeleteProgram) \
+    X(DeleteQueries) \
+    X(DeleteRenderbuffers) \
+    X(DeleteShader) \
+    X(DeleteSync) \
+    X(DeleteTextures) \
+    X(DeleteVertexArrays) \
+    X(DepthFunc) \
+    X(DepthMask) \
+    X(Disable) \
+    X(DrawArrays) \
+    X(DrawElementsInstanced) \
+    X(Enable) \
+    X(EnableVertexAttribArray) \
+    X(EndQuery) \
+    X(EndTransformFeedback) \
+    X(FenceSync) \
+    X(FramebufferRenderbuffer) \
+    X(GenBuffers) \
+    X(GenFramebuffers) \
+    X(GenQueries) \
+    X(GenRenderbuffers) \
+    X(GenTextures) \
+    X(GenVertexArrays) \
+    X(GenerateMipmap) \
+    X(GetUniformBlockIndex) \
+    X(GetUniformLocation) \
+    X(InvalidateFramebuffer) \
+    X(LinkProgram) \
+    X(MapBufferRange) \
+    X(PixelStorei) \
+    X(ReadPixels) \
+    X(RenderbufferStorage) \
+    X(Scissor) \
+    X(ShaderSource) \
+    X(TexImage2D) \
+    X(TexParameteri) \
+    X(TransformFeedbackVaryings) \
+    X(Uniform1i) \
+    X(UniformBlockBinding) \
+    X(UnmapBuffer) \
+    X(UseProgram) \
+    X(VertexAttribDivisor) \
+    X(VertexAttribPointer) \
+    X(Viewport)
+
+    enum Call : uint16_t {
+        //! end of a frame, arguments: surface width and height
+        kFrame,
+#define GL_TRACE_ENUM(name) k##name,
+        GL_TRACE_CALLS(GL_TRACE_ENUM)
+#undef GL_TRACE_ENUM
+        kCallCount
+    };
+
+    //! values glPixelStorei accepts for GL_UNPACK_ALIGNMENT, others leave it unchanged
+    constexpr bool isUnpackAlignment(int32_t value) {
+        return value == 1 || value == 2 || value == 4 || value == 8;
+    }
+
+    /*!
+     * Bytes glTexImage2D reads from client memory, rows padded to @a unpackAlignment, the last
+     * GL_UNPACK_ALIGNMENT set before the call. 0 for negative sizes, GL reads nothing then.
+     */
+    inline uint64_t imageSize(int32_t width, int32_t height, uint32_t format, uint32_t type,
+                              int32_t unpackAlignment) {
+        if (width < 0 || height < 0) return 0;
+        uint64_t components;
+        switch (format) {
+            case GL_RGBA:
+            case GL_RGBA_INTEGER:
+                components = 4;
+                break;
+            case GL_RGB:
+            case GL_RGB_INTEGER:
+                components = 3;
+                break;
+            case GL_RG:
+            case GL_RG_INTEGER:
+            case GL_LUMINANCE_ALPHA:
+                components = 2;
+                break;
+            default:
+                components = 1;
+        }
+        uint64_t pixelSize;
+        switch (type) {
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                pixelSize = 2;
+                break;
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+            case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            case GL_UNSIGNED_INT_5_9_9_9_REV:
+            case GL_UNSIGNED_INT_24_8:
+                pixelSize = 4;
+                break;
+            case GL_UNSIGNED_SHORT:
+            case GL_SHORT:
+            case GL_HALF_FLOAT:
+                pixelSize = 2 * components;
+                break;
+            case GL_UNSIGNED_INT:
+            case GL_INT:
+            case GL_FLOAT:
+                pixelSize = 4 * components;
+                break;
+            default:
+                pixelSize = components;
+        }
+        uint64_t alignment = unpackAlignment;
+        auto row = (width * pixelSize + alignment - 1) / alignment * alignment;
+        return row * static_cast<uint64_t>(height);
+    }
+
+    inline const char *callName(uint16_t call) {
+        static const char *const names[] = {
+                "eglSwapBuffers",
+#define GL_TRACE_NAME(name) "gl" #name,
+                GL_TRACE_CALLS(GL_TRACE_NAME)
+#undef GL_TRACE_NAME
+        };
+        return call < kCallCount ? names[call] : "unknown";
+    }
+}
+
+
+#endif //EGL_LEARNING_GLTRACEFORMAT_H
@@ -0,0 +1,115 @@
+#if defined(EGL_HEAP_GUARD)
+
+#include "HeapGuard.h"
+
+#include <android/log.h>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    //! the guarded scope of this thread, null when allocation is allowed
+    thread_local const char *guardedScope = nullptr;
+
+    // 不能用 debug/warn 输出, 它们可能再次分配; __android_log_assert 只用栈上的缓冲
+    void check(size_t size) {
+        if (guardedScope) {
+            auto scope = guardedScope;
+            guardedScope = nullptr;
+            __android_log_assert(
+                    "heap guard", "GL_ES", "heap allocation of %zu bytes inside %s", size, scope);
+        }
+    }
+
+    void *tryAllocate(size_t size, size_t alignment) {
+        check(size);
+        size = size ? size : 1;
+        return alignment > alignof(std::max_align_t)
+               ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+               : std::malloc(size);
+    }
+
+    void *allocate(size_t size, size_t alignment) {
+        auto memory = tryAllocate(size, alignment);
+        if (!memory) {
+            __android_log_assert("heap guard", "GL_ES", "out of memory, %zu bytes", size);
+        }
+        return memory;
+    }
+}
+
+HeapGuard::HeapGuard(const char *scope) : previous_(guardedScope) {
+    guardedScope = scope;
+}
+
+HeapGuard::~HeapGuard() {
+    guardedScope = previous_;
+}
+
+HeapGuard::Allow::Allow() : scope_(guardedScope) {
+    guardedScope = nullptr;
+}
+
+HeapGuard::Allow::~Allow() {
+    guardedScope = scope_;
+}
+
+// 替换全局的 new/delete, 整个库(包括 libc++ 内部)的分配都会经过这里
+
+void *operator new(size_t size) {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new[](size_t size) {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return tryAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return tryAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef EGL_LEARNING_HEAPGUARD_H
+#define EGL_LEARNING_HEAPGUARD_H
+
+/*!
+ * Debug check that per-frame code stays off the general heap, compiled in with the
+ * EGL_HEAP_GUARD CMake option.
+ *
+ * @a HEAP_GUARD() forbids heap allocation on the calling thread until the end of the enclosing
+ * scope; the instrumented global operator new aborts with the scope's name when it is hit, so
+ * the tombstone points at the allocation. Transient data belongs in the @a FrameArena instead.
+ * Deliberate allocations, such as screenshots, lift the guard with @a HEAP_GUARD_ALLOW().
+ * Other threads are not checked.
+ *
+ * Without the option both macros expand to nothing.
+ */
+#if defined(EGL_HEAP_GUARD)
+
+class HeapGuard {
+public:
+    explicit HeapGuard(const char *scope);
+
+    ~HeapGuard();
+
+    HeapGuard(const HeapGuard &) = delete;
+
+    HeapGuard &operator=(const HeapGuard &) = delete;
+
+    //! lifts the guard of the calling thread until destroyed
+    class Allow {
+    public:
+        Allow();
+
+        ~Allow();
+
+        Allow(const Allow &) = delete;
+
+        Allow &operator=(const Allow &) = delete;
+
+    private:
+        const char *scope_;
+    };
+
+private:
+    const char *previous_;
+};
+
+#define HEAP_GUARD(scope) HeapGuard heapGuard(scope)
+#define HEAP_GUARD_ALLOW() HeapGuard::Allow heapGuardAllow
+
+#else
+
+#define HEAP_GUARD(scope)
+#define HEAP_GUARD_ALLOW()
+
+#endif
+
+
+#endif //EGL_LEARNING_HEAPGUARD_H
@@ -1,11 +1,29 @@
+#include <cstring>
 #include <memory>
 
 #include "Image.h"
 #include "AndroidOut.h"
 
+void flipRows(const uint8_t *source, uint8_t *destination, size_t stride, int32_t height) {
+    for (int32_t y = 0; y < height; ++y) {
+        std::memcpy(destination + (height - y - 1) * stride, source + y * stride, stride);
+    }
+}
+
 std::shared_ptr<Image> Image::load(
         AAssetManager *assetManager,
         const std::string &assetPath
+) {
+    auto data = decode(assetManager, assetPath);
+    if (!data) {
+        return nullptr;
+    }
+    return upload(*data);
+}
+
+std::unique_ptr<ImageData> Image::decode(
+        AAssetManager *assetManager,
+        const std::string &assetPath
 ) {
     auto asset = AAssetManager_open(
             assetManager,
@@ -21,6 +39,7 @@ std::shared_ptr<Image> Image::load(
     auto create = AImageDecoder_createFromAAsset(asset, &decoder);
     if (ANDROID_IMAGE_DECODER_SUCCESS != create) {
         warn << "image create failure, path: " << assetPath << std::endl;
+        AAsset_close(asset);
         return nullptr;
     }
 
@@ -33,10 +52,12 @@ std::shared_ptr<Image> Image::load(
     auto width = AImageDecoderHeaderInfo_getWidth(header);
     auto height = AImageDecoderHeaderInfo_getHeight(header);
     auto stride = AImageDecoder_getMinimumStride(decoder);
+    auto opaque = AImageDecoderHeaderInfo_getAlphaFlags(header) == ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE;
     debug << "image info:"
           << " [width: " << width << "]"
           << " [height: " << height << "]"
           << " [stride: " << stride << "]"
+          << " [opaque: " << opaque << "]"
           << std::endl;
 
     auto decodeData = std::make_unique<std::vector<uint8_t>>(height * stride);
@@ -46,23 +67,25 @@ std::shared_ptr<Image> Image::load(
             stride,
             decodeData->size()
     );
+    AImageDecoder_delete(decoder);
+    AAsset_close(asset);
     if (ANDROID_IMAGE_DECODER_SUCCESS != decode) {
         warn << "image decode failure, path: " << assetPath << std::endl;
         return nullptr;
     }
 
     // 图片数据将左上角视为圆点,GL将右下角视为原点,需要将图片上下翻转才能正确显示
-    auto verticalFlippedData = std::make_unique<std::vector<uint8_t>>(height * stride);
-    for (int y = 0; y < height; ++y) {
-        int srcOffset = y * stride;
-        int destOffset = (height - y - 1) * stride;
-        std::memcpy(
-                verticalFlippedData->data() + destOffset,
-                decodeData->data() + srcOffset,
-                stride
-        );
-    }
+    auto verticalFlippedData = std::make_unique<ImageData>();
+    verticalFlippedData->width = width;
+    verticalFlippedData->height = height;
+    verticalFlippedData->stride = stride;
+    verticalFlippedData->opaque = opaque;
+    verticalFlippedData->pixels.resize(height * stride);
+    flipRows(decodeData->data(), verticalFlippedData->pixels.data(), stride, height);
+    return verticalFlippedData;
+}
 
+std::shared_ptr<Image> Image::upload(const ImageData &data) {
     GLuint texture;
     glGenTextures(1, &texture);
     debug << "gl textureId: " << texture << std::endl;
@@ -80,19 +103,16 @@ std::shared_ptr<Image> Image::load(
             GL_TEXTURE_2D,
             0,
             GL_RGBA,
-            width,
-            height,
+            data.width,
+            data.height,
             0,
             GL_RGBA,
             GL_UNSIGNED_BYTE,
-            verticalFlippedData->data()
+            data.pixels.data()
     );
 
 
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    AImageDecoder_delete(decoder);
-    AAsset_close(asset);
-
-    return std::shared_ptr<Image>(new Image(texture));
+    return std::shared_ptr<Image>(new Image(texture, data.opaque));
 }
@@ -1,21 +1,59 @@
 #include <string>
 #include <android/asset_manager.h>
 #include <android/imagedecoder.h>
+#include <memory>
 #include <vector>
 #include <GLES3/gl3.h>
+#include "GlTrace.h"
 
 #ifndef EGL_LEARNING_IMAGE_H
 #define EGL_LEARNING_IMAGE_H
 
+/*!
+ * Decoded RGBA pixels, already flipped to GL's bottom-left origin
+ */
+struct ImageData {
+    int32_t width;
+    int32_t height;
+    size_t stride;
+    //! true when the decoder reports no alpha channel, such images can skip blending
+    bool opaque;
+    std::vector<uint8_t> pixels;
+};
+
+/*!
+ * Copies @a height rows of @a stride bytes from @a source to @a destination in reverse order,
+ * converting between top-down images (decoders, PNG) and GL's bottom-up rows. The buffers must
+ * not overlap.
+ */
+void flipRows(const uint8_t *source, uint8_t *destination, size_t stride, int32_t height);
+
 class Image {
 public:
     GLuint texture_;
+    bool opaque_;
 
+    /*!
+     * Decodes and uploads in one go, must run on the GL thread
+     */
     static std::shared_ptr<Image> load(
             AAssetManager *assetManager,
             const std::string &assetPath
     );
 
+    /*!
+     * CPU half of @a load(). Does not touch GL, so it can run on a job system worker.
+     */
+    static std::unique_ptr<ImageData> decode(
+            AAssetManager *assetManager,
+            const std::string &assetPath
+    );
+
+    /*!
+     * GL half of @a load(), must run on the GL thread
+     */
+    static std::shared_ptr<Image> upload(const ImageData &data);
+
     inline ~Image() {
         if (texture_) {
             glDeleteTextures(1, &texture_);
@@ -25,7 +63,7 @@ public:
 
 private:
 
-    inline Image(GLint texture) : texture_(texture) {}
+    inline Image(GLint texture, bool opaque) : texture_(texture), opaque_(opaque) {}
 
 };
 
@@ -0,0 +1,88 @@
+#include "Input.h"
+
+#include <android/input.h>
+#include <android/keycodes.h>
+
+#include "AndroidOut.h"
+
+static void logPointer(const GameActivityPointerAxes &pointer) {
+    debug << "(" << pointer.id << ", " << GameActivityPointerAxes_getX(&pointer) << ", "
+          << GameActivityPointerAxes_getY(&pointer) << ")";
+}
+
+InputCommands processInput(const android_input_buffer &inputBuffer) {
+    InputCommands commands;
+
+    // handle motion events (motionEventsCounts can be 0).
+    for (uint64_t i = 0; i < inputBuffer.motionEventsCount; i++) {
+        auto &motionEvent = inputBuffer.motionEvents[i];
+        auto action = motionEvent.action;
+
+        // Find the pointer index, mask and bitshift to turn it into a readable value.
+        auto pointerIndex = (action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK)
+                >> AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+        debug << "Pointer(s): ";
+
+        // determine the action type and process the event accordingly.
+        switch (action & AMOTION_EVENT_ACTION_MASK) {
+            case AMOTION_EVENT_ACTION_DOWN:
+            case AMOTION_EVENT_ACTION_POINTER_DOWN:
+                logPointer(motionEvent.pointers[pointerIndex]);
+                debug << " Pointer Down";
+                break;
+
+            case AMOTION_EVENT_ACTION_CANCEL:
+                // treat the CANCEL as an UP event: doing nothing in the app, except
+                // removing the pointer from the cache if pointers are locally saved.
+                // code pass through on purpose.
+            case AMOTION_EVENT_ACTION_UP:
+            case AMOTION_EVENT_ACTION_POINTER_UP:
+                logPointer(motionEvent.pointers[pointerIndex]);
+                debug << " Pointer Up";
+                break;
+
+            case AMOTION_EVENT_ACTION_MOVE:
+                // There is no pointer index for ACTION_MOVE, only a snapshot of
+                // all active pointers; app needs to cache previous active pointers
+                // to figure out which ones are actually moved.
+                for (uint32_t index = 0; index < motionEvent.pointerCount; index++) {
+                    logPointer(motionEvent.pointers[index]);
+
+                    if (index != (motionEvent.pointerCount - 1)) debug << ",";
+                    debug << " ";
+                }
+                debug << "Pointer Move";
+                break;
+            default:
+                debug << "Unknown MotionEvent Action: " << action;
+        }
+        debug << std::endl;
+    }
+
+    // handle input key events.
+    for (uint64_t i = 0; i < inputBuffer.keyEventsCount; i++) {
+        auto &keyEvent = inputBuffer.keyEvents[i];
+        debug << "Key: " << keyEvent.keyCode << " ";
+        switch (keyEvent.action) {
+            case AKEY_EVENT_ACTION_DOWN:
+                debug << "Key Down";
+                break;
+            case AKEY_EVENT_ACTION_UP:
+                debug << "Key Up";
+                if (keyEvent.keyCode == AKEYCODE_C) {
+                    commands.screenshots++;
+                } else if (keyEvent.keyCode == AKEYCODE_O) {
+                    commands.overdrawToggles++;
+                }
+                break;
+            case AKEY_EVENT_ACTION_MULTIPLE:
+                // Deprecated since Android API level 29.
+                debug << "Multiple Key Actions";
+                break;
+            default:
+                debug << "Unknown KeyEvent Action: " << keyEvent.action;
+        }
+        debug << std::endl;
+    }
+    return commands;
+}
@@ -0,0 +1,21 @@
+#ifndef EGL_LEARNING_INPUT_H
+#define EGL_LEARNING_INPUT_H
+
+#include <game-activity/native_app_glue/android_native_app_glue.h>
+
+//! what the renderer should do in response to one batch of input events
+struct InputCommands {
+    //! number of capture key releases
+    int screenshots = 0;
+    //! number of overdraw key releases, an odd count flips the visualization
+    int overdrawToggles = 0;
+};
+
+/*!
+ * Logs the queued motion and key events of @a inputBuffer and collects the commands they trigger.
+ * The buffer is only read, the caller clears it afterwards so the main thread can reuse it.
+ */
+InputCommands processInput(const android_input_buffer &inputBuffer);
+
+
+#endif //EGL_LEARNING_INPUT_H
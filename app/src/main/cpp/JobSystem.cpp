@@ -0,0 +1,308 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "AndroidOut.h"
+
+//! the job system the current thread belongs to, and its slot in @a JobSystem::contexts_
+static thread_local JobSystem *tlsSystem = nullptr;
+static thread_local size_t tlsIndex = 0;
+
+bool WorkStealingQueue::push(Job *job) {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(kCapacity)) {
+        return false;
+    }
+    jobs_[bottom & kMask].store(job, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job *WorkStealingQueue::pop() {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        // 队列本来就是空的
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto job = jobs_[bottom & kMask].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // 最后一个元素, 和偷取者竞争
+        if (!top_.compare_exchange_strong(
+                top, top + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job *WorkStealingQueue::steal() {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    auto job = jobs_[top & kMask].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(
+            top, top + 1,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+/*!
+ * Reads the maximum frequency of every core, 0 when the kernel does not expose it
+ */
+static std::vector<long> readCoreFrequencies() {
+    auto cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<long> frequencies(cores, 0);
+    for (unsigned core = 0; core < cores; ++core) {
+        char path[96];
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", core);
+        auto file = fopen(path, "r");
+        if (!file) continue;
+        if (fscanf(file, "%ld", &frequencies[core]) != 1) frequencies[core] = 0;
+        fclose(file);
+    }
+    return frequencies;
+}
+
+/*!
+ * Cores are grouped into clusters by maximum frequency. Every cluster above the slowest one is
+ * big, so prime + big + little SoCs get their prime and big cores; with a single cluster every
+ * core is big and none is little.
+ */
+static bool coreMatches(CoreAffinity affinity, long frequency, long minFrequency, long maxFrequency) {
+    switch (affinity) {
+        case CoreAffinity::kBig:
+            return frequency > minFrequency || minFrequency == maxFrequency;
+        case CoreAffinity::kLittle:
+            return frequency == minFrequency && minFrequency < maxFrequency;
+        default:
+            return true;
+    }
+}
+
+int JobSystem::coreCount(CoreAffinity affinity) {
+    return coreCount(affinity, readCoreFrequencies());
+}
+
+int JobSystem::coreCount(CoreAffinity affinity, const std::vector<long> &frequencies) {
+    if (frequencies.empty()) return 0;
+    auto range = std::minmax_element(frequencies.begin(), frequencies.end());
+    int count = 0;
+    for (auto frequency: frequencies) {
+        if (coreMatches(affinity, frequency, *range.first, *range.second)) ++count;
+    }
+    return count;
+}
+
+void JobSystem::_applyAffinity(CoreAffinity affinity) {
+#if defined(__linux__)
+    if (affinity == CoreAffinity::kAny) return;
+
+    auto frequencies = readCoreFrequencies();
+    auto range = std::minmax_element(frequencies.begin(), frequencies.end());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int count = 0;
+    for (size_t core = 0; core < frequencies.size(); ++core) {
+        if (coreMatches(affinity, frequencies[core], *range.first, *range.second)) {
+            CPU_SET(core, &set);
+            ++count;
+        }
+    }
+    // 只是提示, 设置失败时让调度器自己决定
+    if (count && sched_setaffinity(0, sizeof set, &set) != 0) {
+        warn << "sched_setaffinity failure" << std::endl;
+    }
+#endif
+}
+
+JobSystem::JobSystem(const Options &options) {
+    auto affinity = options.affinity;
+    if (coreCount(affinity) == 0) affinity = CoreAffinity::kAny;
+
+    auto workerCount = options.workerCount;
+    if (workerCount < 0) {
+        workerCount = std::max(1, coreCount(affinity) - 1);
+    }
+
+    for (int i = 0; i <= workerCount; ++i) {
+        auto context = std::make_unique<ThreadContext>();
+        context->jobPool = std::make_unique<Job[]>(WorkStealingQueue::kCapacity);
+        for (size_t job = 0; job < WorkStealingQueue::kCapacity; ++job) {
+            context->jobPool[job].owner = static_cast<uint32_t>(i);
+            context->jobPool[job].next = job + 1 < WorkStealingQueue::kCapacity
+                                         ? &context->jobPool[job + 1] : nullptr;
+        }
+        context->freeJobs = &context->jobPool[0];
+        contexts_.push_back(std::move(context));
+    }
+
+    assert(!tlsSystem);
+    tlsSystem = this;
+    tlsIndex = 0;
+
+    for (int i = 1; i <= workerCount; ++i) {
+        workers_.emplace_back(&JobSystem::_workerMain, this, i, affinity);
+    }
+    debug << "job system started with " << workerCount << " workers" << std::endl;
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_.store(true);
+    }
+    wakeUp_.notify_all();
+    for (auto &worker: workers_) {
+        worker.join();
+    }
+    if (tlsSystem == this) {
+        tlsSystem = nullptr;
+    }
+}
+
+JobSystem::ThreadContext &JobSystem::_currentContext() {
+    assert(tlsSystem == this && "jobs must be submitted from the owning thread or a job");
+    return *contexts_[tlsIndex];
+}
+
+void JobSystem::run(
+        JobFunction function,
+        void *data,
+        size_t begin,
+        size_t end,
+        JobCounter *counter
+) {
+    auto &context = _currentContext();
+    auto job = _allocateJob(context);
+    if (!job) {
+        // 记录都在队列里, 直接在当前线程执行; 计数器没有加过, 也不用减
+        function(data, begin, end);
+        return;
+    }
+
+    job->function = function;
+    job->data = data;
+    job->begin = begin;
+    job->end = end;
+    job->counter = counter;
+    if (counter) counter->value_.fetch_add(1, std::memory_order_relaxed);
+    // 队列和记录池一样大, 空闲记录不为空时队列不会满
+    context.queue.push(job);
+
+    // 和 _workerMain 中的 sleepers_/pending_ 检查成对, 保证不会丢失唤醒
+    pending_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        wakeUp_.notify_one();
+    }
+}
+
+void JobSystem::runBackground(JobFunction function, void *data) {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        background_.push_back({function, data, 0, 1, nullptr});
+    }
+    wakeUp_.notify_one();
+}
+
+Job *JobSystem::_findJob(size_t self) {
+    auto job = contexts_[self]->queue.pop();
+    for (size_t i = 1; !job && i < contexts_.size(); ++i) {
+        job = contexts_[(self + i) % contexts_.size()]->queue.steal();
+    }
+    if (job) pending_.fetch_sub(1);
+    return job;
+}
+
+Job *JobSystem::_allocateJob(ThreadContext &context) {
+    if (!context.freeJobs) {
+        context.freeJobs = context.releasedJobs.exchange(nullptr, std::memory_order_acquire);
+        if (!context.freeJobs) return nullptr;
+    }
+    auto job = context.freeJobs;
+    context.freeJobs = job->next;
+    return job;
+}
+
+void JobSystem::_execute(Job *job) {
+    // 先拷出来再归还记录, 任务里提交的新任务可能马上复用它
+    auto copy = *job;
+    if (copy.owner != Job::kUnpooled) {
+        auto &released = contexts_[copy.owner]->releasedJobs;
+        job->next = released.load(std::memory_order_relaxed);
+        while (!released.compare_exchange_weak(
+                job->next, job,
+                std::memory_order_release,
+                std::memory_order_relaxed)) {}
+    }
+    copy.function(copy.data, copy.begin, copy.end);
+    if (copy.counter) copy.counter->value_.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    while (!counter.done()) {
+        // 等待的同时帮忙执行, 剩下的任务都在别的线程上运行时让出时间片
+        auto job = _findJob(tlsIndex);
+        if (job) {
+            _execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::_workerMain(size_t index, CoreAffinity affinity) {
+    tlsSystem = this;
+    tlsIndex = index;
+    _applyAffinity(affinity);
+
+    while (true) {
+        auto job = _findJob(index);
+        if (job) {
+            _execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (!background_.empty()) {
+            // 没有常规任务时才执行后台任务
+            auto background = background_.front();
+            background_.pop_front();
+            lock.unlock();
+            _execute(&background);
+            continue;
+        }
+
+        sleepers_.fetch_add(1);
+        wakeUp_.wait(lock, [this] {
+            return pending_.load() > 0 || !background_.empty() || stopping_.load();
+        });
+        sleepers_.fetch_sub(1);
+        if (stopping_.load() && pending_.load() == 0 && background_.empty()) {
+            return;
+        }
+    }
+}
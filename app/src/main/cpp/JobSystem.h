@@ -0,0 +1,215 @@
+#ifndef EGL_LEARNING_JOBSYSTEM_H
+#define EGL_LEARNING_JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * Counts outstanding jobs. Every job submitted with a counter increments it, and finishing the
+ * job decrements it, so waiting for zero waits for the whole group.
+ */
+class JobCounter {
+public:
+    inline bool done() const { return value_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int32_t> value_{0};
+};
+
+/*!
+ * Job entry point. [begin, end) is the range handed to the job, plain jobs get [0, 1).
+ */
+typedef void (*JobFunction)(void *data, size_t begin, size_t end);
+
+struct Job {
+    //! @a owner of jobs that do not come from a thread's pool
+    static constexpr uint32_t kUnpooled = UINT32_MAX;
+
+    JobFunction function;
+    void *data;
+    size_t begin;
+    size_t end;
+    JobCounter *counter;
+    //! free list link while the record is unused
+    Job *next = nullptr;
+    //! slot of the thread whose pool the record belongs to
+    uint32_t owner = kUnpooled;
+};
+
+/*!
+ * Which cores the worker threads should run on. Cores are grouped into clusters by their maximum
+ * frequency: the slowest cluster is little, all faster ones (big and prime) are big. On
+ * symmetric CPUs every core counts as big.
+ */
+enum class CoreAffinity {
+    kAny,
+    kBig,
+    kLittle,
+};
+
+/*!
+ * Chase-Lev work stealing deque of job pointers. The owning thread pushes and pops at the
+ * bottom, any other thread steals from the top.
+ */
+class WorkStealingQueue {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    //! owner only, returns false when the queue is full
+    bool push(Job *job);
+
+    //! owner only, stealers can only make the queue shorter
+    inline bool full() const {
+        return bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_acquire)
+               >= static_cast<int64_t>(kCapacity);
+    }
+
+    //! owner only
+    Job *pop();
+
+    //! any thread
+    Job *steal();
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "capacity must be a power of two");
+
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Job *> jobs_[kCapacity];
+};
+
+/*!
+ * Work stealing scheduler. Every worker thread, plus the thread that created the system, owns a
+ * @a WorkStealingQueue; idle workers steal from the others and sleep on a condition variable
+ * when there is nothing left, so an idle system burns no CPU.
+ *
+ * Jobs may only be submitted from the creating thread or from inside a job. Job records come
+ * from a per-thread pool of @a WorkStealingQueue::kCapacity entries; whichever thread runs a job
+ * copies its record and hands it back to the pool before calling it. A thread whose records are
+ * all queued runs further jobs inline instead.
+ */
+class JobSystem {
+public:
+    struct Options {
+        //! number of worker threads, -1 picks one per core in @a affinity minus the caller
+        int workerCount = -1;
+        CoreAffinity affinity = CoreAffinity::kAny;
+    };
+
+    explicit JobSystem(const Options &options);
+
+    JobSystem() : JobSystem(Options()) {}
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    inline size_t workerCount() const { return workers_.size(); }
+
+    /*!
+     * Queues @a function on the calling thread's deque, @a counter may be null.
+     */
+    void run(JobFunction function, void *data, size_t begin, size_t end, JobCounter *counter);
+
+    /*!
+     * Queues a long running job that only idle workers pick up, after all regular jobs. Waiting
+     * threads never help with these, so a frame's @a wait() cannot get stuck behind one.
+     * Safe to call from any thread; needs at least one worker.
+     */
+    void runBackground(JobFunction function, void *data);
+
+    /*!
+     * Runs queued jobs on the calling thread until @a counter drops to zero.
+     */
+    void wait(JobCounter &counter);
+
+    /*!
+     * Splits [begin, end) into ranges of at most @a grain elements and calls
+     * `fn(rangeBegin, rangeEnd)` for each of them, in parallel. Returns once all ranges are done.
+     */
+    template<typename Fn>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Fn &fn) {
+        if (begin >= end) return;
+        // 限制任务数量, 避免单次调用用完job环形缓冲
+        grain = std::max(grain, (end - begin + kMaxParallelForJobs - 1) / kMaxParallelForJobs);
+        if (end - begin <= grain) {
+            fn(begin, end);
+            return;
+        }
+
+        JobFunction call = [](void *data, size_t rangeBegin, size_t rangeEnd) {
+            (*static_cast<const Fn *>(data))(rangeBegin, rangeEnd);
+        };
+        JobCounter counter;
+        for (auto rangeBegin = begin; rangeBegin < end; rangeBegin += grain) {
+            auto rangeEnd = end - rangeBegin > grain ? rangeBegin + grain : end;
+            run(call, const_cast<Fn *>(&fn), rangeBegin, rangeEnd, &counter);
+        }
+        wait(counter);
+    }
+
+    /*!
+     * Number of online cores matching @a affinity
+     */
+    static int coreCount(CoreAffinity affinity);
+
+    /*!
+     * Number of cores matching @a affinity, given every core's maximum frequency
+     */
+    static int coreCount(CoreAffinity affinity, const std::vector<long> &frequencies);
+
+private:
+    static constexpr size_t kMaxParallelForJobs = WorkStealingQueue::kCapacity / 4;
+
+    struct ThreadContext {
+        WorkStealingQueue queue;
+        std::unique_ptr<Job[]> jobPool;
+        //! owner only
+        Job *freeJobs = nullptr;
+        //! records returned by any thread, the owner takes the whole list when @a freeJobs runs dry
+        std::atomic<Job *> releasedJobs{nullptr};
+    };
+
+    //! index 0 belongs to the creating thread, 1..n to the workers
+    std::vector<std::unique_ptr<ThreadContext>> contexts_;
+    std::vector<std::thread> workers_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeUp_;
+    std::atomic<int32_t> pending_{0};
+    std::atomic<int32_t> sleepers_{0};
+    std::atomic<bool> stopping_{false};
+    //! guarded by @a sleepMutex_
+    std::deque<Job> background_;
+
+    void _workerMain(size_t index, CoreAffinity affinity);
+
+    ThreadContext &_currentContext();
+
+    //! pops from the calling thread's deque first, then steals round robin
+    Job *_findJob(size_t self);
+
+    //! copies the job, returns its record to the pool, then runs it
+    void _execute(Job *job);
+
+    //! owner only, null when every record is in use
+    static Job *_allocateJob(ThreadContext &context);
+
+    static void _applyAffinity(CoreAffinity affinity);
+};
+
+
+#endif //EGL_LEARNING_JOBSYSTEM_H
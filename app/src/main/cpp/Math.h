@@ -0,0 +1,226 @@
+#ifndef EGL_LEARNING_MATH_H
+#define EGL_LEARNING_MATH_H
+
+#include <cmath>
+#include <limits>
+
+/*!
+ * Small vector/matrix/quaternion types for the renderer.
+ *
+ * Matrices are column-major so that @a Mat4::m can be handed to glUniformMatrix4fv without
+ * transposing. Everything that does not need a transcendental function is constexpr, which lets
+ * fixed projections be folded at compile time.
+ */
+
+struct Vec2 {
+    float x, y;
+};
+
+struct Vec3 {
+    float x, y, z;
+
+    constexpr Vec3 operator+(const Vec3 &o) const { return {x + o.x, y + o.y, z + o.z}; }
+
+    constexpr Vec3 operator-(const Vec3 &o) const { return {x - o.x, y - o.y, z - o.z}; }
+
+    constexpr Vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+
+    constexpr float dot(const Vec3 &o) const { return x * o.x + y * o.y + z * o.z; }
+
+    constexpr Vec3 cross(const Vec3 &o) const {
+        return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x};
+    }
+
+    inline float length() const { return std::sqrt(dot(*this)); }
+
+    inline Vec3 normalized() const {
+        auto len = length();
+        return len > 0.f ? *this * (1.f / len) : *this;
+    }
+};
+
+struct Vec4 {
+    float x, y, z, w;
+};
+
+/*!
+ * Axis aligned rectangle in world space, used for the visible area, the simulation area and
+ * damage regions
+ */
+struct Rect {
+    float left, bottom, right, top;
+
+    //! contains nothing, the identity of @a united()
+    static constexpr Rect empty() {
+        return {std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+                -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+    }
+
+    //! square around a circle
+    static constexpr Rect around(float x, float y, float radius) {
+        return {x - radius, y - radius, x + radius, y + radius};
+    }
+
+    constexpr bool isEmpty() const { return left > right || bottom > top; }
+
+    constexpr Rect united(const Rect &o) const {
+        return {left < o.left ? left : o.left,
+                bottom < o.bottom ? bottom : o.bottom,
+                right > o.right ? right : o.right,
+                top > o.top ? top : o.top};
+    }
+
+    constexpr Rect intersected(const Rect &o) const {
+        return {left > o.left ? left : o.left,
+                bottom > o.bottom ? bottom : o.bottom,
+                right < o.right ? right : o.right,
+                top < o.top ? top : o.top};
+    }
+};
+
+namespace detail {
+
+    //! constexpr sine for |x| <= pi/2, enough for the half angles used by projections
+    constexpr float sinSeries(float x) {
+        float x2 = x * x;
+        return x * (1.f - x2 / 6.f * (1.f - x2 / 20.f * (1.f - x2 / 42.f * (1.f - x2 / 72.f))));
+    }
+
+    //! constexpr cosine for |x| <= pi/2
+    constexpr float cosSeries(float x) {
+        float x2 = x * x;
+        return 1.f - x2 / 2.f * (1.f - x2 / 12.f * (1.f - x2 / 30.f * (1.f - x2 / 56.f)));
+    }
+}
+
+struct Mat4 {
+    float m[16];
+
+    constexpr const float *data() const { return m; }
+
+    constexpr float operator()(int row, int column) const { return m[column * 4 + row]; }
+
+    static constexpr Mat4 identity() {
+        return {{1, 0, 0, 0,
+                 0, 1, 0, 0,
+                 0, 0, 1, 0,
+                 0, 0, 0, 1}};
+    }
+
+    static constexpr Mat4 translation(const Vec3 &t) {
+        return {{1, 0, 0, 0,
+                 0, 1, 0, 0,
+                 0, 0, 1, 0,
+                 t.x, t.y, t.z, 1}};
+    }
+
+    static constexpr Mat4 scale(const Vec3 &s) {
+        return {{s.x, 0, 0, 0,
+                 0, s.y, 0, 0,
+                 0, 0, s.z, 0,
+                 0, 0, 0, 1}};
+    }
+
+    /*!
+     * Same convention as glOrtho: maps [left, right] x [bottom, top] x [-near, -far] to the
+     * clip cube.
+     */
+    static constexpr Mat4 ortho(
+            float left, float right,
+            float bottom, float top,
+            float near, float far
+    ) {
+        return {{2.f / (right - left), 0, 0, 0,
+                 0, 2.f / (top - bottom), 0, 0,
+                 0, 0, -2.f / (far - near), 0,
+                 -(right + left) / (right - left),
+                 -(top + bottom) / (top - bottom),
+                 -(far + near) / (far - near),
+                 1}};
+    }
+
+    //! Same convention as glFrustum
+    static constexpr Mat4 frustum(
+            float left, float right,
+            float bottom, float top,
+            float near, float far
+    ) {
+        return {{2.f * near / (right - left), 0, 0, 0,
+                 0, 2.f * near / (top - bottom), 0, 0,
+                 (right + left) / (right - left),
+                 (top + bottom) / (top - bottom),
+                 -(far + near) / (far - near),
+                 -1,
+                 0, 0, -2.f * far * near / (far - near), 0}};
+    }
+
+    /*!
+     * @param fovY vertical field of view in radians, must be in (0, pi)
+     */
+    static constexpr Mat4 perspective(float fovY, float aspect, float near, float far) {
+        float half = fovY * .5f;
+        float cotangent = detail::cosSeries(half) / detail::sinSeries(half);
+        return {{cotangent / aspect, 0, 0, 0,
+                 0, cotangent, 0, 0,
+                 0, 0, -(far + near) / (far - near), -1,
+                 0, 0, -2.f * far * near / (far - near), 0}};
+    }
+
+    constexpr Mat4 operator*(const Mat4 &o) const {
+        Mat4 result{};
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                float sum = 0;
+                for (int k = 0; k < 4; ++k) {
+                    sum += m[k * 4 + row] * o.m[column * 4 + k];
+                }
+                result.m[column * 4 + row] = sum;
+            }
+        }
+        return result;
+    }
+
+    constexpr Vec4 operator*(const Vec4 &v) const {
+        return {m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+                m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+                m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+                m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w};
+    }
+};
+
+struct Quat {
+    float x, y, z, w;
+
+    static constexpr Quat identity() { return {0, 0, 0, 1}; }
+
+    /*!
+     * @param axis must be normalized
+     * @param angle in radians
+     */
+    static inline Quat fromAxisAngle(const Vec3 &axis, float angle) {
+        auto s = std::sin(angle * .5f);
+        return {axis.x * s, axis.y * s, axis.z * s, std::cos(angle * .5f)};
+    }
+
+    constexpr Quat operator*(const Quat &o) const {
+        return {w * o.x + x * o.w + y * o.z - z * o.y,
+                w * o.y - x * o.z + y * o.w + z * o.x,
+                w * o.z + x * o.y - y * o.x + z * o.w,
+                w * o.w - x * o.x - y * o.y - z * o.z};
+    }
+
+    constexpr Vec3 rotate(const Vec3 &v) const {
+        Vec3 u{x, y, z};
+        Vec3 t = u.cross(v) * 2.f;
+        return v + t * w + u.cross(t);
+    }
+
+    constexpr Mat4 toMat4() const {
+        return {{1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0,
+                 2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0,
+                 2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0,
+                 0, 0, 0, 1}};
+    }
+};
+
+#endif //EGL_LEARNING_MATH_H
@@ -0,0 +1,221 @@
+#include "ParticleSystem.h"
+
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+
+#include "AndroidOut.h"
+#include "AssetFile.h"
+
+bool ParticleSystem::parseEmitter(const std::string &source, EmitterParams &params) {
+    std::istringstream lines(source);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        auto comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        auto equals = line.find('=');
+        if (equals == std::string::npos) continue;
+
+        std::istringstream keyStream(line.substr(0, equals));
+        std::istringstream value(line.substr(equals + 1));
+        std::string key;
+        keyStream >> key;
+
+        if (key == "count") value >> params.count;
+        else if (key == "position") value >> params.position.x >> params.position.y >> params.position.z;
+        else if (key == "direction") value >> params.direction.x >> params.direction.y >> params.direction.z;
+        else if (key == "spread") value >> params.spread;
+        else if (key == "speedMin") value >> params.speedMin;
+        else if (key == "speedMax") value >> params.speedMax;
+        else if (key == "lifetimeMin") value >> params.lifetimeMin;
+        else if (key == "lifetimeMax") value >> params.lifetimeMax;
+        else if (key == "gravity") value >> params.gravity.x >> params.gravity.y >> params.gravity.z;
+        else if (key == "pointSize") value >> params.pointSize;
+        else if (key == "image") value >> params.image;
+        else {
+            warn << "emitter line " << lineNumber << ": unknown key " << key << std::endl;
+            continue;
+        }
+
+        if (value.fail()) {
+            warn << "emitter line " << lineNumber << ": bad value for " << key << std::endl;
+            return false;
+        }
+    }
+
+    params.direction = params.direction.normalized();
+    return params.count > 0;
+}
+
+std::unique_ptr<ParticleSystem> ParticleSystem::load(
+        AAssetManager *assetManager,
+        const std::string &emitterPath
+) {
+    std::string source;
+    if (!readAssetFile(assetManager, emitterPath, source)) {
+        warn << "emitter open failure, path: " << emitterPath << std::endl;
+        return nullptr;
+    }
+
+    EmitterParams params;
+    if (!parseEmitter(source, params)) {
+        warn << "emitter parse failure, path: " << emitterPath << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<Shader> updateShader(Shader::loadShader(
+            assetManager,
+            "shader/particle_update_vertex.glsl",
+            "shader/particle_update_fragment.glsl",
+            {"vPositionAge", "vVelocityLifetime"}
+    ));
+    std::unique_ptr<Shader> renderShader(Shader::loadShader(
+            assetManager,
+            "shader/particle_render_vertex.glsl",
+            "shader/particle_render_fragment.glsl"
+    ));
+    if (!updateShader || !renderShader) {
+        return nullptr;
+    }
+    if (!updateShader->bindUniformBlock<CameraBlock>()
+        || !updateShader->bindUniformBlock<EmitterBlock>()
+        || !renderShader->bindUniformBlock<CameraBlock>()
+        || !renderShader->bindUniformBlock<EmitterBlock>()) {
+        return nullptr;
+    }
+
+    auto image = Image::load(assetManager, params.image);
+    if (!image) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<ParticleSystem>(new ParticleSystem(
+            params,
+            std::move(updateShader),
+            std::move(renderShader),
+            image
+    ));
+}
+
+ParticleSystem::ParticleSystem(
+        const EmitterParams &params,
+        std::unique_ptr<Shader> updateShader,
+        std::unique_ptr<Shader> renderShader,
+        std::shared_ptr<Image> image
+) : params_(params),
+    updateShader_(std::move(updateShader)),
+    renderShader_(std::move(renderShader)),
+    image_(std::move(image)),
+    current_(0),
+    reset_(true),
+    emitterRange_{0, 0} {
+
+    // 两个VBO只分配空间, 初始内容由第一次 update() 的重置生成
+    glGenBuffers(2, buffers_);
+    glGenVertexArrays(2, vaos_);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers_[i]);
+        glBufferData(
+                GL_ARRAY_BUFFER,
+                params_.count * sizeof(Particle),
+                nullptr,
+                GL_DYNAMIC_COPY
+        );
+
+        glBindVertexArray(vaos_[i]);
+        glVertexAttribPointer(
+                0,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(Particle),
+                (void *) offsetof(Particle, positionAge)
+        );
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(
+                1,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(Particle),
+                (void *) offsetof(Particle, velocityLifetime)
+        );
+        glEnableVertexAttribArray(1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // 采样器不能放进uniform block, 只设置一次
+    renderShader_->setInt("uTexture", 0);
+
+    debug << "particle system with " << params_.count << " particles" << std::endl;
+}
+
+ParticleSystem::~ParticleSystem() {
+    glDeleteVertexArrays(2, vaos_);
+    glDeleteBuffers(2, buffers_);
+}
+
+Rect ParticleSystem::bounds() const {
+    auto lifetime = params_.lifetimeMax;
+    auto travel = params_.speedMax * lifetime;
+    auto fall = .5f * lifetime * lifetime;
+    auto reachX = travel + std::fabs(params_.gravity.x) * fall;
+    auto reachY = travel + std::fabs(params_.gravity.y) * fall;
+    return {params_.position.x - reachX, params_.position.y - reachY,
+            params_.position.x + reachX, params_.position.y + reachY};
+}
+
+void ParticleSystem::pushUniforms(UniformRing &uniforms) {
+    EmitterBlock block;
+    block.position = std140::Vec4(params_.position, 1.f);
+    block.direction = std140::Vec4(params_.direction, 0.f);
+    block.gravity = std140::Vec4(params_.gravity, 0.f);
+    block.spread = params_.spread;
+    block.speedMin = params_.speedMin;
+    block.speedMax = params_.speedMax;
+    block.lifetimeMin = params_.lifetimeMin;
+    block.lifetimeMax = params_.lifetimeMax;
+    block.pointSize = params_.pointSize;
+    block.reset = reset_ ? 1.f : 0.f;
+    emitterRange_ = uniforms.push(block);
+}
+
+void ParticleSystem::update(const UniformRing &uniforms) {
+    auto source = current_;
+    auto destination = 1 - current_;
+    reset_ = false;
+
+    uniforms.bind<EmitterBlock>(emitterRange_);
+    updateShader_->activate();
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(vaos_[source]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers_[destination]);
+
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, params_.count);
+    glEndTransformFeedback();
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    updateShader_->deactivate();
+
+    current_ = destination;
+}
+
+void ParticleSystem::draw(const UniformRing &uniforms) {
+    uniforms.bind<EmitterBlock>(emitterRange_);
+    renderShader_->activate();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, image_->texture_);
+
+    glBindVertexArray(vaos_[current_]);
+    glDrawArrays(GL_POINTS, 0, params_.count);
+    glBindVertexArray(0);
+
+    renderShader_->deactivate();
+}
@@ -0,0 +1,123 @@
+#ifndef EGL_LEARNING_PARTICLESYSTEM_H
+#define EGL_LEARNING_PARTICLESYSTEM_H
+
+#include <android/asset_manager.h>
+#include <memory>
+#include <string>
+#include <GLES3/gl3.h>
+#include "GlTrace.h"
+#include "Image.h"
+#include "Math.h"
+#include "Shader.h"
+#include "UniformBlocks.h"
+
+/*!
+ * Emitter description, loaded from a `key = value` asset (see assets/particle/fountain.emitter)
+ */
+struct EmitterParams {
+    GLsizei count = 65536;
+    Vec3 position = {0, 0, 0};
+    //! emission direction, rotated around z by up to +-spread radians per particle
+    Vec3 direction = {0, 1, 0};
+    float spread = .3f;
+    float speedMin = 1.f;
+    float speedMax = 2.f;
+    float lifetimeMin = 1.f;
+    float lifetimeMax = 2.f;
+    Vec3 gravity = {0, -1, 0};
+    float pointSize = 4.f;
+    //! asset path of the point sprite texture
+    std::string image;
+};
+
+/*!
+ * Particles simulated entirely on the GPU.
+ *
+ * Positions and velocities live in two VBOs. Every update runs the simulation vertex shader
+ * over one of them with GL_RASTERIZER_DISCARD enabled and captures the result into the other
+ * through transform feedback, then the two swap roles. The CPU only writes one @a EmitterBlock
+ * per frame, no matter how many particles there are.
+ *
+ * Both passes also read @a CameraBlock, which the caller binds before @a update().
+ */
+class ParticleSystem {
+public:
+
+    static std::unique_ptr<ParticleSystem> load(
+            AAssetManager *assetManager,
+            const std::string &emitterPath
+    );
+
+    /*!
+     * Parses an emitter description, unknown keys are logged and skipped.
+     * @return false if a value could not be parsed
+     */
+    static bool parseEmitter(const std::string &source, EmitterParams &params);
+
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem &) = delete;
+
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    /*!
+     * Writes this frame's @a EmitterBlock, call between @a UniformRing::beginFrame() and
+     * @a UniformRing::flush()
+     */
+    void pushUniforms(UniformRing &uniforms);
+
+    /*!
+     * Advances the simulation by the camera block's delta time, must run on the GL thread
+     */
+    void update(const UniformRing &uniforms);
+
+    /*!
+     * Draws the particles written by the last @a update() as point sprites. Belongs to the
+     * translucent pass: expects blending on and depth writes off.
+     */
+    void draw(const UniformRing &uniforms);
+
+    inline const EmitterParams &params() const { return params_; }
+
+    /*!
+     * World area any particle can reach: the emitter position pushed out by the fastest speed
+     * and the gravity over the longest lifetime. Excludes the point size, which is in pixels.
+     */
+    Rect bounds() const;
+
+    /*!
+     * Buffer holding the state written by the last @a update(): per particle an xyz position
+     * with its age and an xyz velocity with its lifetime, as two vec4. For readback in tests.
+     */
+    inline GLuint stateBuffer() const { return buffers_[current_]; }
+
+private:
+    struct Particle {
+        //! xyz position, w age in seconds (negative until the particle is born)
+        float positionAge[4];
+        //! xyz velocity, w lifetime in seconds
+        float velocityLifetime[4];
+    };
+
+    EmitterParams params_;
+    std::unique_ptr<Shader> updateShader_;
+    std::unique_ptr<Shader> renderShader_;
+    std::shared_ptr<Image> image_;
+
+    //! ping-pong buffers and the VAOs reading them, @a current_ holds the latest state
+    GLuint buffers_[2];
+    GLuint vaos_[2];
+    int current_;
+    bool reset_;
+    UniformRange emitterRange_;
+
+    ParticleSystem(
+            const EmitterParams &params,
+            std::unique_ptr<Shader> updateShader,
+            std::unique_ptr<Shader> renderShader,
+            std::shared_ptr<Image> image
+    );
+};
+
+
+#endif //EGL_LEARNING_PARTICLESYSTEM_H
@@ -6,11 +6,16 @@
 #include <vector>
 #include <android/imagedecoder.h>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <random>
 #include <regex>
 #include "Shader.h"
 #include "Image.h"
 
 #include "AndroidOut.h"
+#include "HeapGuard.h"
+#include "Input.h"
 
 //! executes glGetString and outputs the result to logcat
 #define PRINT_GL_STRING(s) {debug << #s": "<< glGetString(s) << std::endl;}
@@ -18,18 +23,16 @@
 /*!
  * @brief if glGetString returns a space separated list of elements, prints each one on a new line
  *
- * This works by creating an istringstream of the input c-style string. Then that is used to create
- * a vector -- each element of the vector is a new element in the input string. Finally a foreach
- * loop consumes this and outputs it to logcat using @a aout
+ * This works by walking the input c-style string in place: each run of non-space characters is
+ * a new element and is written straight to logcat using @a aout, without copying anything.
  */
 #define PRINT_GL_STRING_AS_LIST(s) { \
-std::istringstream extensionStream((const char *) glGetString(s));\
-std::vector<std::string> extensionList(\
-        std::istream_iterator<std::string>{extensionStream},\
-        std::istream_iterator<std::string>());\
+auto list = (const char *) glGetString(s);\
 debug << #s":\n";\
-for (auto& extension: extensionList) {\
-    debug << extension << "\n";\
+while (list && *list) {\
+    auto length = std::strcspn(list, " ");\
+    if (length) debug.write(list, length) << "\n";\
+    list += length + std::strspn(list + length, " ");\
 }\
 debug << std::endl;\
 }
@@ -59,10 +62,89 @@ static constexpr float kProjectionNearPlane = -1.f;
  */
 static constexpr float kProjectionFarPlane = 1.f;
 
+/*!
+ * Number of sprites spawned into the scene
+ */
+static constexpr int kSceneEntityCount = 100000;
+
+/*!
+ * Sprites wander inside this square and wrap around at its edges. It is a lot larger than the
+ * visible area, so most of the scene is rejected by culling on any given frame.
+ */
+static constexpr float kSceneHalfExtent = 3 * kProjectionHalfHeight;
+static constexpr Rect kSceneArea = {
+        -kSceneHalfExtent, -kSceneHalfExtent,
+        kSceneHalfExtent, kSceneHalfExtent
+};
+
+/*!
+ * Upper bound of the simulation step, keeps sprites from jumping after a long stall
+ */
+static constexpr float kMaxDeltaTime = 1 / 15.f;
+
+/*!
+ * Bytes of uniform data each frame may write, see @a UniformRing
+ */
+static constexpr GLsizeiptr kUniformFrameSize = 16 * 1024;
+
+/*!
+ * Bytes per half of the frame arena, see @a FrameArena. The visible sprite instances dominate:
+ * up to about a third of @a kSceneEntityCount on a landscape screen, 32 bytes each.
+ */
+static constexpr size_t kFrameArenaCapacity = 2 * 1024 * 1024;
+
+/*!
+ * Default bounds of the dynamic resolution scale, see @a Renderer::setResolutionBounds()
+ */
+static constexpr float kMinResolutionScale = .5f;
+static constexpr float kMaxResolutionScale = 1.f;
+
+/*!
+ * Pixels added around every damage rect: antialiased sprite edges and the bilinear upscale both
+ * reach one pixel past the geometry
+ */
+static constexpr float kDamagePadding = 2.f;
+
+/*!
+ * Weight of the overlay texture (texture1) in every sprite material
+ */
+static constexpr float kOverlayTextureMix = .2f;
+
 GLuint VAO;
 GLuint EBO;
+GLuint instanceVBO;
+
+/*!
+ * GLES3 has no base instance, so point the per-instance attributes at the first instance of a
+ * batch before each instanced draw. Expects the VAO and @a instanceVBO to be bound.
+ */
+static void bindInstanceRange(GLuint first) {
+    auto offset = first * sizeof(SpriteInstance);
+    glVertexAttribPointer(
+            3,
+            4,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(SpriteInstance),
+            (void *) (offset + offsetof(SpriteInstance, basis))
+    );
+    glVertexAttribPointer(
+            4,
+            4,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(SpriteInstance),
+            (void *) (offset + offsetof(SpriteInstance, translation))
+    );
+}
 
 void Renderer::_initRenderer() {
+    // 工作线程只放在大核上, 调用线程(也就是GL线程)自己也会参与执行
+    JobSystem::Options jobOptions;
+    jobOptions.affinity = CoreAffinity::kBig;
+    jobs_ = std::make_unique<JobSystem>(jobOptions);
+    scene_.setJobSystem(jobs_.get());
+
     // Choose your render attributes
     constexpr EGLint attributes[] = {
             EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
@@ -129,6 +211,12 @@ void Renderer::_initRenderer() {
     display_ = display;
     surface_ = surface;
     context_ = context;
+    damage_.init(display_, surface_);
+
+#if defined(EGL_GL_TRACE)
+    // 从第一个GL调用开始录制, 用 tools/glreplay 回放
+    gltrace::start((std::string(app_->activity->internalDataPath) + "/session.gltrace").c_str());
+#endif
 
     // make width and height invalid so it gets updated the first frame in @a updateRenderArea()
     width_ = -1;
@@ -201,6 +289,15 @@ void Renderer::_initRenderer() {
     );
     glEnableVertexAttribArray(textureCorIndex);
 
+    // 实例属性, index为3和4, 每个实例前进一次, 数据每帧由剔除结果填充
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    bindInstanceRange(0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
     // 完事之后解绑
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
@@ -223,27 +320,91 @@ void Renderer::_initRenderer() {
         glClearColor(ERROR_COLOR);
         return;
     }
-
-    image0_ = Image::load(assetManager, "picture/wall.jpg");
-    if (!image0_.get()) {
+    if (!shader_->bindUniformBlock<CameraBlock>()
+        || !shader_->bindUniformBlock<MaterialBlock>()) {
         glClearColor(ERROR_COLOR);
         return;
     }
-    shader_->setInt("texture0", 0);
+    uniforms_ = std::make_unique<UniformRing>(kUniformFrameSize);
+    frameArena_ = std::make_unique<FrameArena>(kFrameArenaCapacity);
+
+    // 解码在工作线程上并行进行, 上传纹理必须回到GL线程
+    const char *imagePaths[] = {
+            "picture/wall.jpg",
+            "picture/android_robot.png",
+            "picture/awesomeface.png"
+    };
+    constexpr size_t imageCount = sizeof imagePaths / sizeof imagePaths[0];
+    std::unique_ptr<ImageData> decoded[imageCount];
+    jobs_->parallelFor(0, imageCount, 1, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            decoded[i] = Image::decode(assetManager, imagePaths[i]);
+        }
+    });
 
-    image1_ = Image::load(assetManager, "picture/awesomeface.png");
-    if (!image1_.get()) {
-        glClearColor(ERROR_COLOR);
-        return;
+    for (size_t i = 0; i < imageCount; ++i) {
+        if (!decoded[i]) {
+            glClearColor(ERROR_COLOR);
+            return;
+        }
+    }
+
+    // 最后一张是叠加在所有精灵上的图片, 其余的都是精灵图片
+    for (size_t i = 0; i + 1 < imageCount; ++i) {
+        spriteImages_.push_back(Image::upload(*decoded[i]));
+
+        MaterialBlock material;
+        material.tint = std140::Vec4(1.f, 1.f, 1.f, 1.f);
+        material.textureMix = kOverlayTextureMix;
+        materials_.push_back(material);
+
+        // 带alpha通道或者色调半透明的材质需要混合, 其余的走不透明通道
+        if (!spriteImages_.back()->opaque_ || material.tint.w < 1.f) {
+            translucentImages_ |= 1u << i;
+        }
     }
+    materialRanges_.resize(materials_.size());
+    shader_->setInt("texture0", 0);
+
+    image1_ = Image::upload(*decoded[imageCount - 1]);
     shader_->setInt("texture1", 1);
 
+    overdrawShader_ = std::unique_ptr<Shader>(
+            Shader::loadShader(
+                    assetManager,
+                    "shader/vertex.glsl",
+                    "shader/overdraw_fragment.glsl"
+            )
+    );
+    if (!overdrawShader_ || !overdrawShader_->bindUniformBlock<CameraBlock>()) {
+        overdrawShader_.reset();
+        warn << "overdraw view disabled" << std::endl;
+    }
+
+    particles_ = ParticleSystem::load(assetManager, "particle/fountain.emitter");
+    if (!particles_) {
+        warn << "particle system disabled" << std::endl;
+    }
+
+    _spawnScene();
+
+    capture_ = std::make_unique<FrameCapture>(*jobs_);
+
+    // 离屏目标的大小在 _updateRenderArea() 里第一次拿到surface尺寸时分配
+    ResolutionSettings resolution;
+    resolution.minScale = kMinResolutionScale;
+    resolution.maxScale = kMaxResolutionScale;
+    resolution_ = ResolutionController(resolution);
+    framebuffer_ = std::make_unique<ScaledFramebuffer>();
+    gpuTimer_ = std::make_unique<GpuTimer>();
+
 //------
 
     glClearColor(CORNFLOWER_BLUE);
 
-    // enable alpha globally for now, you probably don't want to do this in a game
-    glEnable(GL_BLEND);
+    // 深度缓冲在选择EGL配置时已经分配了; 混合只在半透明通道里按需开启
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 }
@@ -259,10 +420,82 @@ void Renderer::_updateRenderArea() {
         width_ = width;
         height_ = height;
         glViewport(0, 0, width, height);
+        damage_.resize(width, height);
+        if (framebuffer_
+            && !framebuffer_->resize(width, height, resolution_.settings().maxScale)) {
+            warn << "dynamic resolution disabled" << std::endl;
+            framebuffer_.reset();
+        }
+
+        // 宽度跟随屏幕宽高比, 高度固定为 2 * kProjectionHalfHeight
+        auto halfWidth = kProjectionHalfHeight * float(width) / float(height);
+        viewProjection_ = Mat4::ortho(
+                -halfWidth, halfWidth,
+                -kProjectionHalfHeight, kProjectionHalfHeight,
+                kProjectionNearPlane, kProjectionFarPlane
+        );
+        view_ = {-halfWidth, -kProjectionHalfHeight, halfWidth, kProjectionHalfHeight};
+    }
+}
+
+void Renderer::_drawBatches(const ArenaVector<DrawBatch> &batches) {
+    for (auto &batch: batches) {
+        // GL_TEXTURE0 放当前批次的图片
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, spriteImages_[batch.image]->texture_);
+        uniforms_->bind<MaterialBlock>(materialRanges_[batch.image]);
+
+        bindInstanceRange(batch.first);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, batch.count);
     }
 }
 
+DamageRect Renderer::_damageRect(const Rect &world, float padding) const {
+    auto scaleX = width_ / (view_.right - view_.left);
+    auto scaleY = height_ / (view_.top - view_.bottom);
+    // 先在浮点数里夹到屏幕附近, 转整数时不会溢出
+    auto toPixels = [padding](float world, float origin, float scale, float size, bool lower) {
+        auto pixel = (world - origin) * scale + (lower ? -padding : padding);
+        pixel = std::min(std::max(pixel, -1.f), size + 1.f);
+        return static_cast<EGLint>(lower ? std::floor(pixel) : std::ceil(pixel));
+    };
+    auto left = toPixels(world.left, view_.left, scaleX, width_, true);
+    auto right = toPixels(world.right, view_.left, scaleX, width_, false);
+    auto bottom = toPixels(world.bottom, view_.bottom, scaleY, height_, true);
+    auto top = toPixels(world.top, view_.bottom, scaleY, height_, false);
+    return {left, bottom, right - left, top - bottom};
+}
+
+void Renderer::_spawnScene() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-kSceneHalfExtent, kSceneHalfExtent);
+    std::uniform_real_distribution<float> depth(kProjectionNearPlane, kProjectionFarPlane);
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    std::uniform_real_distribution<float> size(.02f, .06f);
+    std::uniform_real_distribution<float> speed(-.5f, .5f);
+    std::uniform_int_distribution<uint32_t> image(0, spriteImages_.size() - 1);
+
+    auto mask = kComponentTransform | kComponentSprite | kComponentBounds | kComponentVelocity;
+    for (int i = 0; i < kSceneEntityCount; ++i) {
+        auto entity = scene_.create(mask);
+        auto scale = size(random);
+        scene_.setTransform(entity, {{position(random), position(random), depth(random)},
+                                     angle(random),
+                                     {scale, scale}});
+        scene_.setSprite(entity, {image(random)});
+        // 单位四边形的外接圆半径是 sqrt(0.5)
+        scene_.setBounds(entity, {scale * .70710678f});
+        scene_.setVelocity(entity, {{speed(random), speed(random)}});
+    }
+    debug << "spawned " << scene_.size() << " entities" << std::endl;
+
+    lastFrameTime_ = std::chrono::steady_clock::now();
+}
+
 Renderer::~Renderer() {
+#if defined(EGL_GL_TRACE)
+    gltrace::stop();
+#endif
     if (display_ != EGL_NO_DISPLAY) {
         eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         if (context_ != EGL_NO_CONTEXT) {
@@ -279,6 +512,8 @@ Renderer::~Renderer() {
 }
 
 void Renderer::handleInput() {
+    HEAP_GUARD("Renderer::handleInput");
+
     // handle all queued inputs
     auto *inputBuffer = android_app_swap_input_buffers(app_);
     if (!inputBuffer) {
@@ -286,97 +521,140 @@ void Renderer::handleInput() {
         return;
     }
 
-    // handle motion events (motionEventsCounts can be 0).
-    for (auto i = 0; i < inputBuffer->motionEventsCount; i++) {
-        auto &motionEvent = inputBuffer->motionEvents[i];
-        auto action = motionEvent.action;
-
-        // Find the pointer index, mask and bitshift to turn it into a readable value.
-        auto pointerIndex = (action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK)
-                >> AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
-        debug << "Pointer(s): ";
-
-        // get the x and y position of this event if it is not ACTION_MOVE.
-        auto &pointer = motionEvent.pointers[pointerIndex];
-        auto x = GameActivityPointerAxes_getX(&pointer);
-        auto y = GameActivityPointerAxes_getY(&pointer);
-
-        // determine the action type and process the event accordingly.
-        switch (action & AMOTION_EVENT_ACTION_MASK) {
-            case AMOTION_EVENT_ACTION_DOWN:
-            case AMOTION_EVENT_ACTION_POINTER_DOWN:
-                debug << "(" << pointer.id << ", " << x << ", " << y << ") "
-                      << "Pointer Down";
-                break;
-
-            case AMOTION_EVENT_ACTION_CANCEL:
-                // treat the CANCEL as an UP event: doing nothing in the app, except
-                // removing the pointer from the cache if pointers are locally saved.
-                // code pass through on purpose.
-            case AMOTION_EVENT_ACTION_UP:
-            case AMOTION_EVENT_ACTION_POINTER_UP:
-                debug << "(" << pointer.id << ", " << x << ", " << y << ") "
-                      << "Pointer Up";
-                break;
-
-            case AMOTION_EVENT_ACTION_MOVE:
-                // There is no pointer index for ACTION_MOVE, only a snapshot of
-                // all active pointers; app needs to cache previous active pointers
-                // to figure out which ones are actually moved.
-                for (auto index = 0; index < motionEvent.pointerCount; index++) {
-                    pointer = motionEvent.pointers[index];
-                    x = GameActivityPointerAxes_getX(&pointer);
-                    y = GameActivityPointerAxes_getY(&pointer);
-                    debug << "(" << pointer.id << ", " << x << ", " << y << ")";
-
-                    if (index != (motionEvent.pointerCount - 1)) debug << ",";
-                    debug << " ";
-                }
-                debug << "Pointer Move";
-                break;
-            default:
-                debug << "Unknown MotionEvent Action: " << action;
-        }
-        debug << std::endl;
-    }
-    // clear the motion input count in this buffer for main thread to re-use.
+    auto commands = processInput(*inputBuffer);
+    // clear the input counts in this buffer for main thread to re-use.
     android_app_clear_motion_events(inputBuffer);
+    android_app_clear_key_events(inputBuffer);
 
-    // handle input key events.
-    for (auto i = 0; i < inputBuffer->keyEventsCount; i++) {
-        auto &keyEvent = inputBuffer->keyEvents[i];
-        debug << "Key: " << keyEvent.keyCode << " ";
-        switch (keyEvent.action) {
-            case AKEY_EVENT_ACTION_DOWN:
-                debug << "Key Down";
-                break;
-            case AKEY_EVENT_ACTION_UP:
-                debug << "Key Up";
-                break;
-            case AKEY_EVENT_ACTION_MULTIPLE:
-                // Deprecated since Android API level 29.
-                debug << "Multiple Key Actions";
-                break;
-            default:
-                debug << "Unknown KeyEvent Action: " << keyEvent.action;
-        }
-        debug << std::endl;
+    // 一批事件里按了多次截图也只截一张
+    if (commands.screenshots) {
+        requestScreenshot();
     }
-    // clear the key input count too.
-    android_app_clear_key_events(inputBuffer);
+    if (commands.overdrawToggles % 2 && overdrawShader_) {
+        showOverdraw_ = !showOverdraw_;
+        damage_.invalidate();
+    }
+}
+
+void Renderer::requestScreenshot() {
+    // 截图是用户触发的, 路径和回调允许分配
+    HEAP_GUARD_ALLOW();
+    auto path = std::string(app_->activity->internalDataPath)
+                + "/screenshot_" + std::to_string(screenshotCount_++) + ".png";
+    capture_->request([path](const CapturedFrame &frame) {
+        FrameCapture::writePng(frame, path);
+    });
+}
+
+void Renderer::setResolutionBounds(float minScale, float maxScale) {
+    if (!resolution_.setBounds(minScale, maxScale)) {
+        return;
+    }
+    if (!framebuffer_ || width_ <= 0) {
+        return;
+    }
+    if (!framebuffer_->resize(width_, height_, resolution_.settings().maxScale)) {
+        warn << "dynamic resolution disabled" << std::endl;
+        framebuffer_.reset();
+    }
+    // 重新分配的 renderbuffer 内容未定义, 不能再只重画脏区
+    damage_.invalidate();
 }
 
 void Renderer::render() {
+    HEAP_GUARD("Renderer::render");
+    frameArena_->beginFrame();
+
     _updateRenderArea();
-    glClear(GL_COLOR_BUFFER_BIT);
+    auto gpuTime = gpuTimer_->poll();
 
-// ----
+    // 只领取已经完成的读回, 不会等待GPU
+    capture_->poll();
+
+    auto now = std::chrono::steady_clock::now();
+    auto deltaTime = std::min(
+            std::chrono::duration<float>(now - lastFrameTime_).count(),
+            kMaxDeltaTime
+    );
+    lastFrameTime_ = now;
+    time_ += deltaTime;
+
+    scene_.integrate(deltaTime, kSceneArea);
+    CullView cullView;
+    cullView.area = view_;
+    // 正交投影沿 -z 方向看, z 越大越靠近相机
+    cullView.nearZ = -kProjectionNearPlane;
+    cullView.farZ = -kProjectionFarPlane;
+    cullView.translucentImages = translucentImages_;
+    DrawList drawList(*frameArena_);
+    scene_.cull(cullView, drawList);
+
+    // 收集本帧的损坏区域: 场景里动过的精灵, 以及粒子可能到达的范围
+    Rect moved;
+    if (scene_.takeDamage(moved)) {
+        damage_.add(_damageRect(moved, kDamagePadding));
+    }
+    if (particles_) {
+        auto pointRadius = particles_->params().pointSize * .5f;
+        damage_.add(_damageRect(particles_->bounds(), pointRadius + kDamagePadding));
+    }
+    auto renderScale = framebuffer_ ? resolution_.scale() : 1.f;
+    if (renderScale != renderedScale_) {
+        damage_.invalidate();
+        renderedScale_ = renderScale;
+    }
+    auto repaint = damage_.beginFrame();
+
+    // 本帧所有的uniform block一次性写入环形缓冲
+    uniforms_->beginFrame();
+    CameraBlock camera;
+    camera.viewProjection = viewProjection_;
+    camera.viewRect = std140::Vec4(view_.left, view_.bottom, view_.right, view_.top);
+    camera.time = time_;
+    camera.deltaTime = deltaTime;
+    camera.resolutionScale = renderScale;
+    auto cameraRange = uniforms_->push(camera);
+    for (size_t i = 0; i < materials_.size(); ++i) {
+        materialRanges_[i] = uniforms_->push(materials_[i]);
+    }
+    if (particles_) {
+        particles_->pushUniforms(*uniforms_);
+    }
+    uniforms_->flush();
+    uniforms_->bind<CameraBlock>(cameraRange);
+
+    gpuTimer_->begin();
+    if (particles_) {
+        particles_->update(*uniforms_);
+    }
+
+    // 离屏目标一直保留着上一帧, 只需要重画本帧变化的部分; 直接画到窗口时按缓冲年龄决定
+    auto scissor = repaint;
+    if (framebuffer_) {
+        framebuffer_->bind(renderScale);
+        auto changed = damage_.frameBounds();
+        auto left = static_cast<GLint>(std::floor(changed.x * renderScale)) - 1;
+        auto bottom = static_cast<GLint>(std::floor(changed.y * renderScale)) - 1;
+        auto right = static_cast<GLint>(std::ceil((changed.x + changed.width) * renderScale)) + 1;
+        auto top = static_cast<GLint>(std::ceil((changed.y + changed.height) * renderScale)) + 1;
+        scissor = changed.isEmpty() ? DamageRect{0, 0, 0, 0}
+                                    : DamageRect{left, bottom, right - left, top - bottom};
+    }
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
+
+    if (showOverdraw_) {
+        glClearColor(0, 0, 0, 1);
+    } else {
+        glClearColor(CORNFLOWER_BLUE);
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    shader_.get()->activate();
+// ----
 
-    // GL_TEXTURE0 默认激活
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, image0_->texture_);
+    // 热力图模式下每个着色的片元都叠加一次, 被深度测试拒绝的片元不计入
+    auto &spriteShader = showOverdraw_ ? overdrawShader_ : shader_;
+    spriteShader->activate();
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, image1_->texture_);
@@ -385,20 +663,66 @@ void Renderer::render() {
     glBindVertexArray(VAO);
     // 选取索引为0的数据
     glEnableVertexAttribArray(0);
-    // 不使用EBO的时候, 可以直接绘制
-    // glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // 本帧可见实例一次性上传, 先丢弃旧的存储避免和GPU争用
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(
+            GL_ARRAY_BUFFER,
+            drawList.instances.size() * sizeof(SpriteInstance),
+            drawList.instances.data(),
+            GL_STREAM_DRAW
+    );
 
     // 使用EBO了, 这需要启用EBO, 再绘制EBO声明的内容
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // 不透明通道: 由近到远, 写深度, 不混合, 被挡住的片元在着色前就被拒绝
+    if (showOverdraw_) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    glDepthMask(GL_TRUE);
+    _drawBatches(drawList.opaque);
+
+    // 半透明通道: 由远到近, 只做深度测试不写深度
+    if (!showOverdraw_) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glDepthMask(GL_FALSE);
+    _drawBatches(drawList.translucent);
 
     // 完事后解绑
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    shader_.get()->deactivate();
+    spriteShader->deactivate();
+
+    if (particles_ && !showOverdraw_) {
+        particles_->draw(*uniforms_);
+    }
+
+    // glClear 也受深度写入开关影响, 下一帧之前要恢复
+    glDepthMask(GL_TRUE);
 // ----
 
-    eglSwapBuffers(display_, surface_);
+    if (framebuffer_) {
+        // blit同样受裁剪测试限制, 只写回需要重画的区域
+        glScissor(repaint.x, repaint.y, repaint.width, repaint.height);
+        framebuffer_->present();
+    }
+    glDisable(GL_SCISSOR_TEST);
+    gpuTimer_->end();
+
+    uniforms_->endFrame();
+    capture_->capture(width_, height_);
+
+    // 几帧前的GPU耗时决定下一帧的分辨率, 交换前的CPU耗时超标时只保持不升高
+    auto cpuTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - now).count();
+    resolution_.update(gpuTime, cpuTime);
+
+    damage_.swap();
 }
\ No newline at end of file
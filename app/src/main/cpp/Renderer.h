@@ -1,11 +1,22 @@
 #ifndef ANDROIDGLINVESTIGATIONS_RENDERER_H
 #define ANDROIDGLINVESTIGATIONS_RENDERER_H
 
+#include <chrono>
 #include <memory>
+#include <vector>
 #include <EGL/egl.h>
 #include <GLES3/gl3.h>
+#include "GlTrace.h"
+#include "DamageTracker.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
 #include "Shader.h"
 #include "Image.h"
+#include "JobSystem.h"
+#include "Math.h"
+#include "ParticleSystem.h"
+#include "Scene.h"
+#include "UniformBlocks.h"
 
 struct android_app;
 
@@ -19,10 +30,56 @@ private:
     EGLint width_;
     EGLint height_;
 
+    //! orthographic projection derived from the surface aspect, updated in @a _updateRenderArea()
+    Mat4 viewProjection_;
+
+    //! shared by asset loading and the scene systems, created first in @a _initRenderer()
+    std::unique_ptr<JobSystem> jobs_;
+
     std::unique_ptr<Shader> shader_;
-    std::shared_ptr<Image> image0_;
+    //! indexed by @a Sprite::image, bound to texture0
+    std::vector<std::shared_ptr<Image>> spriteImages_;
+    //! bit i set when sprite image i is drawn in the translucent pass, see @a CullView
+    uint32_t translucentImages_;
     std::shared_ptr<Image> image1_;
 
+    //! per-frame uniform blocks, see @a UniformRing
+    std::unique_ptr<UniformRing> uniforms_;
+
+    //! one per sprite image, and the ranges they were written to this frame
+    std::vector<MaterialBlock> materials_;
+    std::vector<UniformRange> materialRanges_;
+
+    //! draws every sprite fragment as a constant additive step, toggled with the O key
+    std::unique_ptr<Shader> overdrawShader_;
+    bool showOverdraw_;
+
+    //! optional, the sprites still render when the emitter fails to load
+    std::unique_ptr<ParticleSystem> particles_;
+
+    Scene scene_;
+    //! transient per-frame data such as the draw list
+    std::unique_ptr<FrameArena> frameArena_;
+
+    //! offscreen target the scene renders into at @a resolution_'s scale, null renders directly
+    std::unique_ptr<ScaledFramebuffer> framebuffer_;
+    std::unique_ptr<GpuTimer> gpuTimer_;
+    ResolutionController resolution_;
+    //! scale the offscreen target holds, a different scale invalidates all of it
+    float renderedScale_;
+
+    //! limits each frame to the pixels that changed, see @a DamageTracker
+    DamageTracker damage_;
+
+    //! screenshots, see @a requestScreenshot()
+    std::unique_ptr<FrameCapture> capture_;
+    int screenshotCount_;
+
+    //! visible world area, derived from the projection in @a _updateRenderArea()
+    Rect view_;
+    std::chrono::steady_clock::time_point lastFrameTime_;
+    float time_;
+
     /*!
      * Performs necessary OpenGL initialization. Customize this if you want to change your EGL
      * context or application-wide settings.
@@ -31,6 +88,22 @@ private:
 
     void _updateRenderArea();
 
+    /*!
+     * Issues one instanced draw per batch. Expects the sprite VAO, @a instanceVBO and a shader
+     * reading @a CameraBlock to be bound.
+     */
+    void _drawBatches(const ArenaVector<DrawBatch> &batches);
+
+    /*!
+     * Converts a world area to surface pixels, grown by @a padding pixels on every side
+     */
+    DamageRect _damageRect(const Rect &world, float padding) const;
+
+    /*!
+     * Fills the scene with randomly placed, moving sprites
+     */
+    void _spawnScene();
+
 public:
     /*!
      * @param pApp the android_app this Renderer belongs to, needed to configure GL
@@ -41,7 +114,14 @@ public:
             surface_(EGL_NO_SURFACE),
             context_(EGL_NO_CONTEXT),
             width_(0),
-            height_(0) { _initRenderer(); }
+            height_(0),
+            viewProjection_(Mat4::identity()),
+            translucentImages_(0),
+            showOverdraw_(false),
+            renderedScale_(0),
+            screenshotCount_(0),
+            view_{0, 0, 0, 0},
+            time_(0) { _initRenderer(); }
 
     virtual ~Renderer();
 
@@ -57,6 +137,18 @@ public:
      */
     void render();
 
+    /*!
+     * Saves the next rendered frame as a PNG in the app's internal data directory, without
+     * stalling the frame
+     */
+    void requestScreenshot();
+
+    /*!
+     * Limits the dynamic resolution scale, reallocating the offscreen target for the new maximum.
+     * Bounds outside 0 < @a minScale <= @a maxScale <= 1 are rejected.
+     */
+    void setResolutionBounds(float minScale, float maxScale);
+
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_RENDERER_H
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+Chunk::Chunk(ComponentMask mask) : mask_(mask), size_(0), motion_(Rect::empty()) {
+    auto allocate = [this](Column first, Column last) {
+        for (int column = first; column <= last; ++column) {
+            columns_[column] = std::make_unique<float[]>(kCapacity);
+        }
+    };
+    if (mask & kComponentTransform) allocate(kColumnX, kColumnScaleY);
+    if (mask & kComponentBounds) allocate(kColumnRadius, kColumnRadius);
+    if (mask & kComponentVelocity) allocate(kColumnVelocityX, kColumnVelocityY);
+    if (mask & kComponentSprite) images_ = std::make_unique<uint32_t[]>(kCapacity);
+
+    if ((mask & kComponentTransform) && (mask & kComponentSprite)) {
+        instances_ = std::make_unique<SpriteInstance[]>(kCapacity);
+    }
+}
+
+Scene::Archetype *Scene::_archetype(ComponentMask mask) {
+    for (auto &archetype: archetypes_) {
+        if (archetype->mask == mask) return archetype.get();
+    }
+    archetypes_.push_back(std::make_unique<Archetype>());
+    auto archetype = archetypes_.back().get();
+    archetype->mask = mask;
+    return archetype;
+}
+
+Scene::EntityRecord *Scene::_record(Entity entity) {
+    if (entity.index >= records_.size()) return nullptr;
+    auto &record = records_[entity.index];
+    if (record.generation != entity.generation || !record.chunk) return nullptr;
+    return &record;
+}
+
+Rect Scene::_rowBounds(const Chunk &chunk, uint32_t row) {
+    auto x = chunk.columns_[Chunk::kColumnX][row];
+    auto y = chunk.columns_[Chunk::kColumnY][row];
+    if (chunk.columns_[Chunk::kColumnRadius]) {
+        return Rect::around(x, y, chunk.columns_[Chunk::kColumnRadius][row]);
+    }
+    auto scaleX = std::fabs(chunk.columns_[Chunk::kColumnScaleX][row]);
+    auto scaleY = std::fabs(chunk.columns_[Chunk::kColumnScaleY][row]);
+    return Rect::around(x, y, std::max(scaleX, scaleY) * .70710678f);
+}
+
+void Scene::_damageRow(const Chunk &chunk, uint32_t row) {
+    // 没有变换或者没有图片的实体画不出来, 不产生损坏区域
+    constexpr ComponentMask visible = kComponentTransform | kComponentSprite;
+    if ((chunk.mask_ & visible) != visible) return;
+    damage_ = damage_.united(_rowBounds(chunk, row));
+}
+
+Entity Scene::create(ComponentMask mask) {
+    auto archetype = _archetype(mask);
+
+    // 空位多半在最后一个chunk, 从后往前找
+    Chunk *chunk = nullptr;
+    for (auto it = archetype->chunks.rbegin(); it != archetype->chunks.rend(); ++it) {
+        if (!(*it)->full()) {
+            chunk = it->get();
+            break;
+        }
+    }
+    if (!chunk) {
+        archetype->chunks.push_back(std::make_unique<Chunk>(mask));
+        chunk = archetype->chunks.back().get();
+        // 查询结果的容量在这里跟上, 逐帧运行的系统就不会再分配
+        queryScratch_.reserve(++chunkCount_);
+    }
+
+    Entity entity{};
+    if (freeIndices_.empty()) {
+        entity.index = static_cast<uint32_t>(records_.size());
+        records_.push_back({0, nullptr, 0});
+    } else {
+        entity.index = freeIndices_.back();
+        freeIndices_.pop_back();
+    }
+    auto &record = records_[entity.index];
+    entity.generation = record.generation;
+
+    auto row = chunk->size_++;
+    record.chunk = chunk;
+    record.row = row;
+    chunk->entities_[row] = entity;
+
+    // 默认值: 原点, 不旋转, 单位缩放, 静止
+    if (mask & kComponentTransform) {
+        chunk->column(Chunk::kColumnX)[row] = 0.f;
+        chunk->column(Chunk::kColumnY)[row] = 0.f;
+        chunk->column(Chunk::kColumnZ)[row] = 0.f;
+        chunk->column(Chunk::kColumnRotationCos)[row] = 1.f;
+        chunk->column(Chunk::kColumnRotationSin)[row] = 0.f;
+        chunk->column(Chunk::kColumnScaleX)[row] = 1.f;
+        chunk->column(Chunk::kColumnScaleY)[row] = 1.f;
+    }
+    if (mask & kComponentBounds) chunk->column(Chunk::kColumnRadius)[row] = 0.f;
+    if (mask & kComponentVelocity) {
+        chunk->column(Chunk::kColumnVelocityX)[row] = 0.f;
+        chunk->column(Chunk::kColumnVelocityY)[row] = 0.f;
+    }
+    if (mask & kComponentSprite) chunk->images()[row] = 0;
+    _damageRow(*chunk, row);
+
+    ++size_;
+    return entity;
+}
+
+void Scene::destroy(Entity entity) {
+    auto record = _record(entity);
+    if (!record) return;
+
+    auto chunk = record->chunk;
+    auto row = record->row;
+    auto last = chunk->size_ - 1;
+    _damageRow(*chunk, row);
+
+    // 用chunk最后一行填补空洞, 保持列连续
+    if (row != last) {
+        for (auto &column: chunk->columns_) {
+            if (column) column[row] = column[last];
+        }
+        if (chunk->images_) chunk->images_[row] = chunk->images_[last];
+        auto moved = chunk->entities_[last];
+        chunk->entities_[row] = moved;
+        records_[moved.index].row = row;
+    }
+    --chunk->size_;
+
+    record->chunk = nullptr;
+    ++record->generation;
+    freeIndices_.push_back(entity.index);
+    --size_;
+
+    if (chunk->size_ == 0) {
+        auto archetype = _archetype(chunk->mask_);
+        if (archetype->chunks.size() > 1) {
+            for (auto it = archetype->chunks.begin(); it != archetype->chunks.end(); ++it) {
+                if (it->get() == chunk) {
+                    archetype->chunks.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool Scene::alive(Entity entity) const {
+    return entity.index < records_.size()
+           && records_[entity.index].generation == entity.generation
+           && records_[entity.index].chunk;
+}
+
+void Scene::setTransform(Entity entity, const Transform &transform) {
+    auto record = _record(entity);
+    if (!record || !(record->chunk->mask_ & kComponentTransform)) return;
+
+    auto chunk = record->chunk;
+    auto row = record->row;
+    _damageRow(*chunk, row);
+    chunk->column(Chunk::kColumnX)[row] = transform.position.x;
+    chunk->column(Chunk::kColumnY)[row] = transform.position.y;
+    chunk->column(Chunk::kColumnZ)[row] = transform.position.z;
+    chunk->column(Chunk::kColumnRotationCos)[row] = std::cos(transform.rotation);
+    chunk->column(Chunk::kColumnRotationSin)[row] = std::sin(transform.rotation);
+    chunk->column(Chunk::kColumnScaleX)[row] = transform.scale.x;
+    chunk->column(Chunk::kColumnScaleY)[row] = transform.scale.y;
+    _damageRow(*chunk, row);
+}
+
+void Scene::setSprite(Entity entity, const Sprite &sprite) {
+    auto record = _record(entity);
+    if (!record || !(record->chunk->mask_ & kComponentSprite)) return;
+    assert(sprite.image < kMaxSpriteImages);
+    record->chunk->images()[record->row] = sprite.image;
+    _damageRow(*record->chunk, record->row);
+}
+
+void Scene::setBounds(Entity entity, const Bounds &bounds) {
+    auto record = _record(entity);
+    if (!record || !(record->chunk->mask_ & kComponentBounds)) return;
+    _damageRow(*record->chunk, record->row);
+    record->chunk->column(Chunk::kColumnRadius)[record->row] = bounds.radius;
+    _damageRow(*record->chunk, record->row);
+}
+
+void Scene::setVelocity(Entity entity, const Velocity &velocity) {
+    auto record = _record(entity);
+    if (!record || !(record->chunk->mask_ & kComponentVelocity)) return;
+    record->chunk->column(Chunk::kColumnVelocityX)[record->row] = velocity.linear.x;
+    record->chunk->column(Chunk::kColumnVelocityY)[record->row] = velocity.linear.y;
+}
+
+void Scene::query(ComponentMask required, std::vector<Chunk *> &chunks) const {
+    chunks.clear();
+    for (auto &archetype: archetypes_) {
+        if ((archetype->mask & required) != required) continue;
+        for (auto &chunk: archetype->chunks) {
+            if (chunk->size_) chunks.push_back(chunk.get());
+        }
+    }
+}
+
+void Scene::_integrateChunk(Chunk &chunk, float deltaTime, const Rect &area) {
+    auto x = chunk.column(Chunk::kColumnX);
+    auto y = chunk.column(Chunk::kColumnY);
+    auto vx = chunk.column(Chunk::kColumnVelocityX);
+    auto vy = chunk.column(Chunk::kColumnVelocityY);
+    auto width = area.right - area.left;
+    auto height = area.top - area.bottom;
+
+    // 没有分支依赖, 编译器可以直接向量化
+    for (uint32_t i = 0; i < chunk.size(); ++i) {
+        auto px = x[i] + vx[i] * deltaTime;
+        auto py = y[i] + vy[i] * deltaTime;
+        px += px < area.left ? width : 0.f;
+        px -= px > area.right ? width : 0.f;
+        py += py < area.bottom ? height : 0.f;
+        py -= py > area.top ? height : 0.f;
+        x[i] = px;
+        y[i] = py;
+    }
+}
+
+void Scene::_accumulateMotion(Chunk &chunk, const float *oldX, const float *oldY) {
+    constexpr ComponentMask visible = kComponentTransform | kComponentSprite;
+    chunk.motion_ = Rect::empty();
+    if ((chunk.mask_ & visible) != visible) return;
+
+    auto x = chunk.column(Chunk::kColumnX);
+    auto y = chunk.column(Chunk::kColumnY);
+    auto vx = chunk.column(Chunk::kColumnVelocityX);
+    auto vy = chunk.column(Chunk::kColumnVelocityY);
+    auto radius = chunk.column(Chunk::kColumnRadius);
+    auto scaleX = chunk.column(Chunk::kColumnScaleX);
+    auto scaleY = chunk.column(Chunk::kColumnScaleY);
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+
+    // 静止的行用无穷大占位, 同样是无分支的最小/最大值归约
+    auto left = infinity, bottom = infinity, right = -infinity, top = -infinity;
+    for (uint32_t i = 0; i < chunk.size(); ++i) {
+        auto r = radius ? radius[i]
+                        : std::max(std::fabs(scaleX[i]), std::fabs(scaleY[i])) * .70710678f;
+        auto moving = vx[i] != 0.f || vy[i] != 0.f;
+        auto minX = std::min(oldX[i], x[i]) - r;
+        auto maxX = std::max(oldX[i], x[i]) + r;
+        auto minY = std::min(oldY[i], y[i]) - r;
+        auto maxY = std::max(oldY[i], y[i]) + r;
+        left = std::min(left, moving ? minX : infinity);
+        right = std::max(right, moving ? maxX : -infinity);
+        bottom = std::min(bottom, moving ? minY : infinity);
+        top = std::max(top, moving ? maxY : -infinity);
+    }
+    chunk.motion_ = {left, bottom, right, top};
+}
+
+void Scene::integrate(float deltaTime, const Rect &area) {
+    query(kComponentTransform | kComponentVelocity, queryScratch_);
+    _forEachChunk([deltaTime, &area](Chunk &chunk) {
+        // 旧位置先留一份, 移动前后的范围都算作损坏区域
+        float oldX[Chunk::kCapacity];
+        float oldY[Chunk::kCapacity];
+        std::memcpy(oldX, chunk.column(Chunk::kColumnX), chunk.size() * sizeof(float));
+        std::memcpy(oldY, chunk.column(Chunk::kColumnY), chunk.size() * sizeof(float));
+        _integrateChunk(chunk, deltaTime, area);
+        _accumulateMotion(chunk, oldX, oldY);
+    });
+    for (auto chunk: queryScratch_) {
+        damage_ = damage_.united(chunk->motion_);
+    }
+}
+
+bool Scene::takeDamage(Rect &damage) {
+    if (damage_.isEmpty()) return false;
+    damage = damage_;
+    damage_ = Rect::empty();
+    return true;
+}
+
+void Scene::_cullChunk(Chunk &chunk, const CullView &view) {
+    auto count = chunk.size();
+    TransformBatch::buildInstances(chunk.transforms(), count, chunk.instances_.get());
+
+    auto x = chunk.column(Chunk::kColumnX);
+    auto y = chunk.column(Chunk::kColumnY);
+    auto z = chunk.column(Chunk::kColumnZ);
+    auto radius = chunk.column(Chunk::kColumnRadius);
+    auto images = chunk.images();
+    auto &area = view.area;
+    auto centerX = (area.left + area.right) * .5f;
+    auto centerY = (area.bottom + area.top) * .5f;
+    auto halfWidth = (area.right - area.left) * .5f;
+    auto halfHeight = (area.top - area.bottom) * .5f;
+
+    uint8_t visible[Chunk::kCapacity];
+    if (radius) {
+        for (uint32_t i = 0; i < count; ++i) {
+            visible[i] = std::fabs(x[i] - centerX) <= halfWidth + radius[i]
+                         && std::fabs(y[i] - centerY) <= halfHeight + radius[i];
+        }
+    } else {
+        // 没有Bounds组件的精灵不参与剔除
+        std::memset(visible, 1, count);
+    }
+
+    // 深度映射到层, 第0层离相机最近
+    uint8_t keys[Chunk::kCapacity];
+    auto layerScale = kDepthLayers / (view.nearZ - view.farZ);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto layer = static_cast<int>((view.nearZ - z[i]) * layerScale);
+        layer = std::min(std::max(layer, 0), static_cast<int>(kDepthLayers) - 1);
+        keys[i] = static_cast<uint8_t>(layer * kMaxSpriteImages + images[i]);
+    }
+
+    // 按(深度层, 图片)做一次计数排序, 让同一个桶的可见实例在chunk内连续
+    std::memset(chunk.keyCounts_, 0, sizeof chunk.keyCounts_);
+    for (uint32_t i = 0; i < count; ++i) {
+        chunk.keyCounts_[keys[i]] += visible[i];
+    }
+    uint32_t cursor[kCullKeys];
+    uint32_t start = 0;
+    for (uint32_t key = 0; key < kCullKeys; ++key) {
+        cursor[key] = start;
+        start += chunk.keyCounts_[key];
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (visible[i]) chunk.visibleRows_[cursor[keys[i]]++] = static_cast<uint16_t>(i);
+    }
+}
+
+void Scene::_emitChunk(Chunk &chunk, SpriteInstance *instances) {
+    uint32_t start = 0;
+    for (uint32_t key = 0; key < kCullKeys; ++key) {
+        auto dst = instances + chunk.keyOffsets_[key];
+        for (uint32_t k = 0; k < chunk.keyCounts_[key]; ++k) {
+            dst[k] = chunk.instances_[chunk.visibleRows_[start + k]];
+        }
+        start += chunk.keyCounts_[key];
+    }
+}
+
+void Scene::_layoutBucket(
+        uint32_t layer,
+        uint32_t image,
+        uint32_t &total,
+        ArenaVector<DrawBatch> &batches
+) {
+    auto key = layer * kMaxSpriteImages + image;
+    auto first = total;
+    for (auto chunk: queryScratch_) {
+        chunk->keyOffsets_[key] = total;
+        total += chunk->keyCounts_[key];
+    }
+    if (total != first) batches.push_back({image, first, total - first});
+}
+
+void Scene::cull(const CullView &view, DrawList &drawList) {
+    query(kComponentTransform | kComponentSprite, queryScratch_);
+    _forEachChunk([&view](Chunk &chunk) {
+        _cullChunk(chunk, view);
+    });
+
+    // 计算每个chunk在输出中的位置, 之后每个chunk可以独立写出
+    // 不透明的桶由近到远排列, 半透明的桶由远到近排列
+    // 在帧分配器里扩容会留下用不上的旧块, 按上限一次分配
+    drawList.opaque.clear();
+    drawList.translucent.clear();
+    drawList.opaque.reserve(kCullKeys);
+    drawList.translucent.reserve(kCullKeys);
+    uint32_t total = 0;
+    for (uint32_t layer = 0; layer < kDepthLayers; ++layer) {
+        for (uint32_t image = 0; image < kMaxSpriteImages; ++image) {
+            if (view.translucentImages & (1u << image)) continue;
+            _layoutBucket(layer, image, total, drawList.opaque);
+        }
+    }
+    for (uint32_t layer = kDepthLayers; layer-- > 0;) {
+        for (uint32_t image = 0; image < kMaxSpriteImages; ++image) {
+            if (!(view.translucentImages & (1u << image))) continue;
+            _layoutBucket(layer, image, total, drawList.translucent);
+        }
+    }
+    drawList.instances.resize(total);
+
+    auto instances = drawList.instances.data();
+    _forEachChunk([instances](Chunk &chunk) {
+        _emitChunk(chunk, instances);
+    });
+}
@@ -0,0 +1,292 @@
+#ifndef EGL_LEARNING_SCENE_H
+#define EGL_LEARNING_SCENE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Math.h"
+#include "TransformBatch.h"
+
+/*!
+ * Entity handle. The index addresses the entity table, the generation detects stale handles
+ * after the slot has been recycled.
+ */
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+};
+
+enum ComponentBit : uint32_t {
+    kComponentTransform = 1u << 0,
+    kComponentSprite = 1u << 1,
+    kComponentBounds = 1u << 2,
+    kComponentVelocity = 1u << 3,
+};
+
+//! Bitwise or of @a ComponentBit, identifies an archetype
+typedef uint32_t ComponentMask;
+
+struct Transform {
+    Vec3 position;
+    //! rotation around z in radians
+    float rotation;
+    Vec2 scale;
+};
+
+struct Sprite {
+    //! index into the renderer's sprite images, must be below @a kMaxSpriteImages
+    uint32_t image;
+};
+
+struct Bounds {
+    //! bounding circle radius in world units, already including the scale
+    float radius;
+};
+
+struct Velocity {
+    Vec2 linear;
+};
+
+//! Upper bound for @a Sprite::image, keeps the per-chunk batching tables fixed size
+static constexpr uint32_t kMaxSpriteImages = 8;
+
+/*!
+ * Culling sorts by depth at this granularity: visible sprites are bucketed into layers between
+ * @a CullView::nearZ and @a CullView::farZ, and each layer is batched by image.
+ */
+static constexpr uint32_t kDepthLayers = 16;
+
+//! one bucket per (depth layer, image) pair, key = layer * kMaxSpriteImages + image
+static constexpr uint32_t kCullKeys = kDepthLayers * kMaxSpriteImages;
+static_assert(kCullKeys <= 256, "cull keys are stored as uint8_t");
+
+/*!
+ * Fixed capacity block of entities sharing one archetype. Every component field is its own
+ * contiguous column (SoA), columns for components missing from the archetype stay null.
+ */
+class Chunk {
+public:
+    static constexpr uint32_t kCapacity = 1024;
+
+    enum Column {
+        kColumnX,
+        kColumnY,
+        kColumnZ,
+        kColumnRotationCos,
+        kColumnRotationSin,
+        kColumnScaleX,
+        kColumnScaleY,
+        kColumnRadius,
+        kColumnVelocityX,
+        kColumnVelocityY,
+        kColumnCount
+    };
+
+    explicit Chunk(ComponentMask mask);
+
+    inline ComponentMask mask() const { return mask_; }
+
+    inline uint32_t size() const { return size_; }
+
+    inline bool full() const { return size_ == kCapacity; }
+
+    inline float *column(Column column) { return columns_[column].get(); }
+
+    inline uint32_t *images() { return images_.get(); }
+
+    inline const Entity *entities() const { return entities_; }
+
+    inline TransformStreams transforms() const {
+        return {columns_[kColumnX].get(),
+                columns_[kColumnY].get(),
+                columns_[kColumnZ].get(),
+                columns_[kColumnRotationCos].get(),
+                columns_[kColumnRotationSin].get(),
+                columns_[kColumnScaleX].get(),
+                columns_[kColumnScaleY].get()};
+    }
+
+private:
+    friend class Scene;
+
+    ComponentMask mask_;
+    uint32_t size_;
+    Entity entities_[kCapacity];
+    std::unique_ptr<float[]> columns_[kColumnCount];
+    std::unique_ptr<uint32_t[]> images_;
+
+    //! area covered by the rows moved in the last @a Scene::integrate(), empty if none moved
+    Rect motion_;
+
+    //! culling scratch, written and consumed within one @a Scene::cull() call
+    std::unique_ptr<SpriteInstance[]> instances_;
+    uint16_t visibleRows_[kCapacity];
+    uint32_t keyCounts_[kCullKeys];
+    uint32_t keyOffsets_[kCullKeys];
+};
+
+/*!
+ * What @a Scene::cull() sees and how it orders the result
+ */
+struct CullView {
+    Rect area;
+    //! world z of the nearest and the farthest depth layer, the camera looks from nearZ to farZ
+    float nearZ;
+    float farZ;
+    //! bit i is set when sprite image i needs blending
+    uint32_t translucentImages;
+};
+
+/*!
+ * Instances of one image in one depth layer, each batch is one instanced draw call.
+ */
+struct DrawBatch {
+    uint32_t image;
+    uint32_t first;
+    uint32_t count;
+};
+
+/*!
+ * Both passes index into the same instance array. Opaque batches run front to back so the depth
+ * test rejects hidden fragments early, translucent batches run back to front so blending
+ * composites correctly. Ordering is exact between depth layers, not within one.
+ *
+ * Built every frame in the @a FrameArena, which keeps it valid until the frame after next.
+ */
+struct DrawList {
+    explicit DrawList(FrameArena &arena) : instances(arena), opaque(arena), translucent(arena) {}
+
+    ArenaVector<SpriteInstance> instances;
+    ArenaVector<DrawBatch> opaque;
+    ArenaVector<DrawBatch> translucent;
+};
+
+/*!
+ * Entity component storage plus the systems that run over it.
+ *
+ * Entities with the same component set live in the same archetype, which owns a list of
+ * @a Chunk. Systems never touch individual entities; they walk chunk lists, so every system is
+ * a loop over independent chunks that is split across the job system when one is set.
+ */
+class Scene {
+public:
+    Scene() = default;
+
+    /*!
+     * @param jobs runs the per-chunk systems in parallel, null runs them on the calling thread
+     */
+    inline void setJobSystem(JobSystem *jobs) { jobs_ = jobs; }
+
+    Scene(const Scene &) = delete;
+
+    Scene &operator=(const Scene &) = delete;
+
+    Entity create(ComponentMask mask);
+
+    void destroy(Entity entity);
+
+    bool alive(Entity entity) const;
+
+    inline uint32_t size() const { return size_; }
+
+    void setTransform(Entity entity, const Transform &transform);
+
+    void setSprite(Entity entity, const Sprite &sprite);
+
+    void setBounds(Entity entity, const Bounds &bounds);
+
+    void setVelocity(Entity entity, const Velocity &velocity);
+
+    /*!
+     * Collects every chunk whose archetype contains all of @a required
+     */
+    void query(ComponentMask required, std::vector<Chunk *> &chunks) const;
+
+    /*!
+     * Movement system: integrates velocity and wraps positions into @a area
+     */
+    void integrate(float deltaTime, const Rect &area);
+
+    /*!
+     * Culling system: rejects sprites whose bounds do not intersect the view area and writes the
+     * survivors into @a drawList, split into passes and sorted by depth layer, then image.
+     */
+    void cull(const CullView &view, DrawList &drawList);
+
+    /*!
+     * Damage system: the world area whose pixels may have changed since the last call. Covers
+     * the old and new bounds of every sprite moved by @a integrate() or @a setTransform(), and
+     * the bounds of created, destroyed or re-imaged sprites.
+     * @return false when nothing changed, @a damage is left untouched then
+     */
+    bool takeDamage(Rect &damage);
+
+private:
+    struct Archetype {
+        ComponentMask mask;
+        std::vector<std::unique_ptr<Chunk>> chunks;
+    };
+
+    struct EntityRecord {
+        uint32_t generation;
+        Chunk *chunk;
+        uint32_t row;
+    };
+
+    std::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::vector<EntityRecord> records_;
+    std::vector<uint32_t> freeIndices_;
+    uint32_t size_ = 0;
+    //! chunks across all archetypes, empty ones included
+    uint32_t chunkCount_ = 0;
+    JobSystem *jobs_ = nullptr;
+    //! accumulated until @a takeDamage()
+    Rect damage_ = Rect::empty();
+
+    //! reused between frames so the per-frame systems do not allocate
+    std::vector<Chunk *> queryScratch_;
+
+    Archetype *_archetype(ComponentMask mask);
+
+    EntityRecord *_record(Entity entity);
+
+    //! bounding square of one row: its Bounds radius, or the circumcircle of its scaled quad
+    static Rect _rowBounds(const Chunk &chunk, uint32_t row);
+
+    //! adds the bounds of a visible row to @a damage_
+    void _damageRow(const Chunk &chunk, uint32_t row);
+
+    //! calls `fn(Chunk &)` for every chunk in @a queryScratch_, in parallel when possible
+    template<typename Fn>
+    void _forEachChunk(const Fn &fn) {
+        if (!jobs_) {
+            for (auto chunk: queryScratch_) fn(*chunk);
+            return;
+        }
+        jobs_->parallelFor(0, queryScratch_.size(), 1, [this, &fn](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) fn(*queryScratch_[i]);
+        });
+    }
+
+    static void _integrateChunk(Chunk &chunk, float deltaTime, const Rect &area);
+
+    //! writes @a Chunk::motion_ from the positions before and after @a _integrateChunk()
+    static void _accumulateMotion(Chunk &chunk, const float *oldX, const float *oldY);
+
+    static void _cullChunk(Chunk &chunk, const CullView &view);
+
+    static void _emitChunk(Chunk &chunk, SpriteInstance *instances);
+
+    //! assigns every chunk's slice of one (layer, image) bucket and records its batch
+    void _layoutBucket(
+            uint32_t layer,
+            uint32_t image,
+            uint32_t &total,
+            ArenaVector<DrawBatch> &batches
+    );
+};
+
+
+#endif //EGL_LEARNING_SCENE_H
@@ -3,6 +3,7 @@
 
 #include "Shader.h"
 #include "AndroidOut.h"
+#include "AssetFile.h"
 
 GLuint Shader::_loadGlShader(
         GLenum shaderType,
@@ -19,13 +20,16 @@ GLuint Shader::_loadGlShader(
             break;
     }
 
-    char *source;
-    _loadAssetFile(assetManager, filePath, &source);
+    std::string source;
+    if (!readAssetFile(assetManager, filePath, source)) {
+        warn << "shader asset open failure, path: " << filePath << std::endl;
+        return 0;
+    }
     debug << prefix << std::endl << source << std::endl;
 
     auto glShader = glCreateShader(shaderType);
-    glShaderSource(glShader, 1, &source, nullptr);
-    delete[] source;
+    auto sourceText = source.c_str();
+    glShaderSource(glShader, 1, &sourceText, nullptr);
     glCompileShader(glShader);
 
     if (!_checkStatus(glShader, true)) {
@@ -35,31 +39,6 @@ GLuint Shader::_loadGlShader(
     }
 }
 
-bool Shader::_loadAssetFile(
-        AAssetManager *assetManager,
-        const std::string &fileName,
-        char **fileContent
-) {
-    AAsset *asset = AAssetManager_open(
-            assetManager,
-            fileName.c_str(),
-            AASSET_MODE_BUFFER);
-
-    if (asset == nullptr) {
-        // 处理错误情况
-        *fileContent = nullptr;
-        return false;
-    }
-
-    auto length = AAsset_getLength(asset);
-    *fileContent = new char[length + 1];
-    AAsset_read(asset, *fileContent, length);
-    (*fileContent)[length] = '\0';
-
-    AAsset_close(asset);
-    return true;
-}
-
 bool Shader::_checkStatus(GLuint handler, bool loggable) {
     int success;
 
@@ -74,7 +53,6 @@ bool Shader::_checkStatus(GLuint handler, bool loggable) {
 
     if (!success && loggable) {
         if (isShader) {
-            int length;
             int typeCode;
             glGetShaderiv(handler, GL_SHADER_TYPE, &typeCode);
 
@@ -82,20 +60,15 @@ bool Shader::_checkStatus(GLuint handler, bool loggable) {
             if (typeCode == GL_VERTEX_SHADER) shaderType = "GL_VERTEX_SHADER";
             if (typeCode == GL_FRAGMENT_SHADER) shaderType = "GL_FRAGMENT_SHADER";
 
-            glGetShaderiv(handler, GL_INFO_LOG_LENGTH, &length);
-            auto log = new GLchar[length];
-            glGetShaderInfoLog(handler, length, nullptr, log);
+            GLchar log[kInfoLogSize];
+            glGetShaderInfoLog(handler, kInfoLogSize, nullptr, log);
             warn << "Compile shader(" << shaderType << ") failure: " << log << std::endl;
-            delete[] log;
         }
 
         if (isProgram) {
-            int length;
-            glGetProgramiv(handler, GL_INFO_LOG_LENGTH, &length);
-            auto log = new GLchar[length];
-            glGetProgramInfoLog(handler, length, nullptr, log);
+            GLchar log[kInfoLogSize];
+            glGetProgramInfoLog(handler, kInfoLogSize, nullptr, log);
             warn << "Program link failure: " << log << std::endl;
-            delete[] log;
         }
     }
 
@@ -105,7 +78,8 @@ bool Shader::_checkStatus(GLuint handler, bool loggable) {
 Shader *Shader::loadShader(
         AAssetManager *assetManager,
         const std::string &vertexSourcePath,
-        const std::string &fragmentSourcePath) {
+        const std::string &fragmentSourcePath,
+        const std::vector<const char *> &feedbackVaryings) {
 
     GLuint vertexShader = _loadGlShader(GL_VERTEX_SHADER, assetManager, vertexSourcePath);
     if (!vertexShader) return nullptr;
@@ -119,6 +93,15 @@ Shader *Shader::loadShader(
     auto program = glCreateProgram();
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
+    if (!feedbackVaryings.empty()) {
+        // 必须在链接之前声明需要捕获的输出
+        glTransformFeedbackVaryings(
+                program,
+                feedbackVaryings.size(),
+                feedbackVaryings.data(),
+                GL_INTERLEAVED_ATTRIBS
+        );
+    }
     glLinkProgram(program);
 
     if (!_checkStatus(program)) {
@@ -141,9 +124,54 @@ void Shader::deactivate() const {
     glUseProgram(0);
 }
 
-void Shader::setInt(std::string name, GLint value) {
+void Shader::setInt(const char *name, GLint value) {
     activate();
-    auto location = glGetUniformLocation(program_, name.c_str());
+    auto location = glGetUniformLocation(program_, name);
     glUniform1i(location, value);
     deactivate();
+}
+
+bool Shader::_bindUniformBlock(
+        const char *blockName,
+        GLuint binding,
+        size_t blockSize,
+        const UniformMember *members,
+        size_t memberCount
+) {
+    auto blockIndex = glGetUniformBlockIndex(program_, blockName);
+    if (blockIndex == GL_INVALID_INDEX) {
+        warn << "uniform block " << blockName << " not found" << std::endl;
+        return false;
+    }
+
+    GLint dataSize;
+    glGetActiveUniformBlockiv(program_, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    bool matches = static_cast<size_t>(dataSize) <= blockSize;
+    if (!matches) {
+        warn << "uniform block " << blockName << " needs " << dataSize
+             << " bytes, struct has " << blockSize << std::endl;
+    }
+
+    // 逐个成员比对程序反射得到的偏移和C++结构体中的偏移
+    for (size_t i = 0; i < memberCount; ++i) {
+        GLuint index;
+        glGetUniformIndices(program_, 1, &members[i].name, &index);
+        if (index == GL_INVALID_INDEX) {
+            warn << "uniform block " << blockName << ": " << members[i].name
+                 << " not found" << std::endl;
+            matches = false;
+            continue;
+        }
+
+        GLint offset;
+        glGetActiveUniformsiv(program_, 1, &index, GL_UNIFORM_OFFSET, &offset);
+        if (static_cast<size_t>(offset) != members[i].offset) {
+            warn << "uniform block " << blockName << ": " << members[i].name
+                 << " at " << offset << ", struct has " << members[i].offset << std::endl;
+            matches = false;
+        }
+    }
+
+    glUniformBlockBinding(program_, blockIndex, binding);
+    return matches;
 }
\ No newline at end of file
@@ -3,7 +3,10 @@
 
 #include <android/asset_manager.h>
 #include <string>
+#include <vector>
 #include <GLES3/gl3.h>
+#include "GlTrace.h"
+#include "UniformBuffer.h"
 
 class Shader {
 private :
@@ -11,11 +14,8 @@ private :
 
     constexpr Shader(GLuint program) : program_(program) {}
 
-    static bool _loadAssetFile(
-            AAssetManager *assetManager,
-            const std::string &fileName,
-            char **fileContent
-    );
+    //! compile and link logs are read into a stack buffer of this size, longer ones are cut
+    static constexpr GLsizei kInfoLogSize = 4096;
 
     static GLuint _loadGlShader(
             GLenum shaderType,
@@ -28,17 +28,47 @@ private :
             bool loggable = true
     );
 
+    bool _bindUniformBlock(
+            const char *blockName,
+            GLuint binding,
+            size_t blockSize,
+            const UniformMember *members,
+            size_t memberCount
+    );
+
 public:
 
+    /*!
+     * @param feedbackVaryings vertex shader outputs captured by transform feedback, interleaved
+     *        in the given order. Leave empty for a regular program.
+     */
     static Shader *loadShader(
             AAssetManager *assetManager,
             const std::string &vertexSourcePath,
-            const std::string &fragmentSourcePath
+            const std::string &fragmentSourcePath,
+            const std::vector<const char *> &feedbackVaryings = {}
     );
 
     void activate() const;
 
-    void setInt(std::string name, int value);
+    void setInt(const char *name, int value);
+
+    /*!
+     * Attaches the uniform block described by @a UniformBlockTraits<Block> to its binding point,
+     * after checking the program's std140 offsets against the C++ struct.
+     * @return false if the block is missing or its layout does not match
+     */
+    template<typename Block>
+    bool bindUniformBlock() {
+        typedef UniformBlockTraits<Block> Traits;
+        return _bindUniformBlock(
+                Traits::kName,
+                Traits::kBinding,
+                sizeof(Block),
+                Traits::kMembers,
+                sizeof Traits::kMembers / sizeof Traits::kMembers[0]
+        );
+    }
 
     void deactivate() const;
 
@@ -0,0 +1,153 @@
+#include "TransformBatch.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_BATCH_NEON 1
+#elif defined(__SSE2__)
+#include <xmmintrin.h>
+#define TRANSFORM_BATCH_SSE 1
+#endif
+
+static inline void _buildInstance(const TransformStreams &t, size_t i, SpriteInstance &out) {
+    out.basis[0] = t.rotationCos[i] * t.scaleX[i];
+    out.basis[1] = t.rotationSin[i] * t.scaleX[i];
+    out.basis[2] = -t.rotationSin[i] * t.scaleY[i];
+    out.basis[3] = t.rotationCos[i] * t.scaleY[i];
+    out.translation[0] = t.x[i];
+    out.translation[1] = t.y[i];
+    out.translation[2] = t.z[i];
+    out.translation[3] = 0.f;
+}
+
+void TransformBatch::buildInstances(
+        const TransformStreams &t,
+        size_t count,
+        SpriteInstance *instances
+) {
+    size_t i = 0;
+    auto *out = reinterpret_cast<float *>(instances);
+
+#if TRANSFORM_BATCH_NEON
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t c = vld1q_f32(t.rotationCos + i);
+        float32x4_t s = vld1q_f32(t.rotationSin + i);
+        float32x4_t sx = vld1q_f32(t.scaleX + i);
+        float32x4_t sy = vld1q_f32(t.scaleY + i);
+
+        float32x4_t c0x = vmulq_f32(c, sx);
+        float32x4_t c0y = vmulq_f32(s, sx);
+        float32x4_t c1x = vnegq_f32(vmulq_f32(s, sy));
+        float32x4_t c1y = vmulq_f32(c, sy);
+        float32x4_t tx = vld1q_f32(t.x + i);
+        float32x4_t ty = vld1q_f32(t.y + i);
+        float32x4_t tz = vld1q_f32(t.z + i);
+
+        // 4x4 转置: 把四个SoA列转成四个实例的AoS行
+        float32x4x2_t basisLo = vzipq_f32(c0x, c1x);
+        float32x4x2_t basisHi = vzipq_f32(c0y, c1y);
+        float32x4x2_t basis01 = vzipq_f32(basisLo.val[0], basisHi.val[0]);
+        float32x4x2_t basis23 = vzipq_f32(basisLo.val[1], basisHi.val[1]);
+
+        float32x4x2_t transLo = vzipq_f32(tx, tz);
+        float32x4x2_t transHi = vzipq_f32(ty, zero);
+        float32x4x2_t trans01 = vzipq_f32(transLo.val[0], transHi.val[0]);
+        float32x4x2_t trans23 = vzipq_f32(transLo.val[1], transHi.val[1]);
+
+        float *dst = out + i * 8;
+        vst1q_f32(dst + 0, basis01.val[0]);
+        vst1q_f32(dst + 4, trans01.val[0]);
+        vst1q_f32(dst + 8, basis01.val[1]);
+        vst1q_f32(dst + 12, trans01.val[1]);
+        vst1q_f32(dst + 16, basis23.val[0]);
+        vst1q_f32(dst + 20, trans23.val[0]);
+        vst1q_f32(dst + 24, basis23.val[1]);
+        vst1q_f32(dst + 28, trans23.val[1]);
+    }
+#elif TRANSFORM_BATCH_SSE
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 c = _mm_loadu_ps(t.rotationCos + i);
+        __m128 s = _mm_loadu_ps(t.rotationSin + i);
+        __m128 sx = _mm_loadu_ps(t.scaleX + i);
+        __m128 sy = _mm_loadu_ps(t.scaleY + i);
+
+        __m128 c0x = _mm_mul_ps(c, sx);
+        __m128 c0y = _mm_mul_ps(s, sx);
+        __m128 c1x = _mm_sub_ps(zero, _mm_mul_ps(s, sy));
+        __m128 c1y = _mm_mul_ps(c, sy);
+        __m128 tx = _mm_loadu_ps(t.x + i);
+        __m128 ty = _mm_loadu_ps(t.y + i);
+        __m128 tz = _mm_loadu_ps(t.z + i);
+        __m128 tw = zero;
+
+        // 4x4 转置: 把四个SoA列转成四个实例的AoS行
+        _MM_TRANSPOSE4_PS(c0x, c0y, c1x, c1y);
+        _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+
+        float *dst = out + i * 8;
+        _mm_storeu_ps(dst + 0, c0x);
+        _mm_storeu_ps(dst + 4, tx);
+        _mm_storeu_ps(dst + 8, c0y);
+        _mm_storeu_ps(dst + 12, ty);
+        _mm_storeu_ps(dst + 16, c1x);
+        _mm_storeu_ps(dst + 20, tz);
+        _mm_storeu_ps(dst + 24, c1y);
+        _mm_storeu_ps(dst + 28, tw);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        _buildInstance(t, i, instances[i]);
+    }
+}
+
+void TransformBatch::transformPoints(
+        const Mat4 &matrix,
+        const float *x,
+        const float *y,
+        const float *z,
+        size_t count,
+        float *outX,
+        float *outY,
+        float *outZ,
+        float *outW
+) {
+    const float *m = matrix.m;
+    float *outputs[4] = {outX, outY, outZ, outW};
+    size_t i = 0;
+
+#if TRANSFORM_BATCH_NEON
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t px = vld1q_f32(x + i);
+        float32x4_t py = vld1q_f32(y + i);
+        float32x4_t pz = vld1q_f32(z + i);
+        for (int row = 0; row < 4; ++row) {
+            float32x4_t r = vdupq_n_f32(m[12 + row]);
+            r = vmlaq_n_f32(r, px, m[row]);
+            r = vmlaq_n_f32(r, py, m[4 + row]);
+            r = vmlaq_n_f32(r, pz, m[8 + row]);
+            vst1q_f32(outputs[row] + i, r);
+        }
+    }
+#elif TRANSFORM_BATCH_SSE
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        for (int row = 0; row < 4; ++row) {
+            __m128 r = _mm_set1_ps(m[12 + row]);
+            r = _mm_add_ps(r, _mm_mul_ps(px, _mm_set1_ps(m[row])));
+            r = _mm_add_ps(r, _mm_mul_ps(py, _mm_set1_ps(m[4 + row])));
+            r = _mm_add_ps(r, _mm_mul_ps(pz, _mm_set1_ps(m[8 + row])));
+            _mm_storeu_ps(outputs[row] + i, r);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        for (int row = 0; row < 4; ++row) {
+            outputs[row][i] = m[row] * x[i] + m[4 + row] * y[i] + m[8 + row] * z[i] + m[12 + row];
+        }
+    }
+}
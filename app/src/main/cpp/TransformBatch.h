@@ -0,0 +1,67 @@
+#ifndef EGL_LEARNING_TRANSFORMBATCH_H
+#define EGL_LEARNING_TRANSFORMBATCH_H
+
+#include <cstddef>
+#include "Math.h"
+
+/*!
+ * Per-instance data consumed by the sprite vertex shader (attribute locations 3 and 4).
+ *
+ * basis holds the two columns of the rotation * scale 2x2 matrix, translation holds the world
+ * position. The local quad vertex is transformed as `mat2(basis) * aPos.xy + translation.xy`.
+ */
+struct SpriteInstance {
+    float basis[4];
+    float translation[4];
+};
+static_assert(sizeof(SpriteInstance) == 8 * sizeof(float), "SpriteInstance must stay tightly packed");
+
+/*!
+ * Read-only views of SoA transform columns. Rotation is stored as cos/sin so the batched
+ * kernels never have to evaluate a transcendental function.
+ */
+struct TransformStreams {
+    const float *x;
+    const float *y;
+    const float *z;
+    const float *rotationCos;
+    const float *rotationSin;
+    const float *scaleX;
+    const float *scaleY;
+};
+
+/*!
+ * Batched transform kernels over SoA data. NEON is used on ARM, SSE on x86, with a scalar
+ * fallback for anything else and for the tail of each batch.
+ */
+class TransformBatch {
+public:
+
+    /*!
+     * Builds one @a SpriteInstance per transform.
+     * @param instances output array of at least @a count elements
+     */
+    static void buildInstances(
+            const TransformStreams &transforms,
+            size_t count,
+            SpriteInstance *instances
+    );
+
+    /*!
+     * Computes `matrix * (x, y, z, 1)` for every point, all inputs and outputs are SoA.
+     */
+    static void transformPoints(
+            const Mat4 &matrix,
+            const float *x,
+            const float *y,
+            const float *z,
+            size_t count,
+            float *outX,
+            float *outY,
+            float *outZ,
+            float *outW
+    );
+};
+
+
+#endif //EGL_LEARNING_TRANSFORMBATCH_H
@@ -0,0 +1,94 @@
+#ifndef EGL_LEARNING_UNIFORMBLOCKS_H
+#define EGL_LEARNING_UNIFORMBLOCKS_H
+
+#include <cstddef>
+#include "UniformBuffer.h"
+
+/*!
+ * The uniform blocks shared by the shaders in assets/shader. Each struct mirrors a
+ * `layout (std140) uniform` block member for member; the static_asserts pin the std140 offsets
+ * at compile time and @a Shader::bindUniformBlock() checks them again against the linked program.
+ */
+
+//! per frame, written once and bound for every pass
+struct CameraBlock {
+    std140::Mat4 viewProjection;
+    //! visible world area: left, bottom, right, top
+    std140::Vec4 viewRect;
+    float time;
+    float deltaTime;
+    //! render target size over surface size, see @a ResolutionController
+    float resolutionScale;
+};
+static_assert(offsetof(CameraBlock, viewRect) == 64, "std140 offset mismatch");
+static_assert(offsetof(CameraBlock, time) == 80, "std140 offset mismatch");
+static_assert(offsetof(CameraBlock, deltaTime) == 84, "std140 offset mismatch");
+static_assert(offsetof(CameraBlock, resolutionScale) == 88, "std140 offset mismatch");
+
+template<>
+struct UniformBlockTraits<CameraBlock> {
+    static constexpr const char *kName = "Camera";
+    static constexpr GLuint kBinding = 0;
+    static constexpr UniformMember kMembers[] = {
+            {"uViewProjection", offsetof(CameraBlock, viewProjection)},
+            {"uViewRect", offsetof(CameraBlock, viewRect)},
+            {"uTime", offsetof(CameraBlock, time)},
+            {"uDeltaTime", offsetof(CameraBlock, deltaTime)},
+            {"uResolutionScale", offsetof(CameraBlock, resolutionScale)},
+    };
+};
+
+//! one per sprite image, bound per draw batch
+struct MaterialBlock {
+    std140::Vec4 tint;
+    //! weight of texture1 over texture0
+    float textureMix;
+};
+static_assert(offsetof(MaterialBlock, textureMix) == 16, "std140 offset mismatch");
+
+template<>
+struct UniformBlockTraits<MaterialBlock> {
+    static constexpr const char *kName = "Material";
+    static constexpr GLuint kBinding = 1;
+    static constexpr UniformMember kMembers[] = {
+            {"uTint", offsetof(MaterialBlock, tint)},
+            {"uTextureMix", offsetof(MaterialBlock, textureMix)},
+    };
+};
+
+//! per particle system, mirrors @a EmitterParams plus the per-frame reset flag
+struct EmitterBlock {
+    std140::Vec4 position;
+    std140::Vec4 direction;
+    std140::Vec4 gravity;
+    float spread;
+    float speedMin;
+    float speedMax;
+    float lifetimeMin;
+    float lifetimeMax;
+    float pointSize;
+    float reset;
+};
+static_assert(offsetof(EmitterBlock, spread) == 48, "std140 offset mismatch");
+static_assert(offsetof(EmitterBlock, reset) == 72, "std140 offset mismatch");
+
+template<>
+struct UniformBlockTraits<EmitterBlock> {
+    static constexpr const char *kName = "Emitter";
+    static constexpr GLuint kBinding = 2;
+    static constexpr UniformMember kMembers[] = {
+            {"uEmitterPosition", offsetof(EmitterBlock, position)},
+            {"uEmitterDirection", offsetof(EmitterBlock, direction)},
+            {"uGravity", offsetof(EmitterBlock, gravity)},
+            {"uEmitterSpread", offsetof(EmitterBlock, spread)},
+            {"uSpeedMin", offsetof(EmitterBlock, speedMin)},
+            {"uSpeedMax", offsetof(EmitterBlock, speedMax)},
+            {"uLifetimeMin", offsetof(EmitterBlock, lifetimeMin)},
+            {"uLifetimeMax", offsetof(EmitterBlock, lifetimeMax)},
+            {"uPointSize", offsetof(EmitterBlock, pointSize)},
+            {"uReset", offsetof(EmitterBlock, reset)},
+    };
+};
+
+
+#endif //EGL_LEARNING_UNIFORMBLOCKS_H
@@ -0,0 +1,124 @@
+#include "UniformBuffer.h"
+
+#include "AndroidOut.h"
+
+/*!
+ * @a UniformRing::beginFrame() waits for a region's fence in slices of this length, and after
+ * @a kFenceMaxWaits slices stops trusting it. Only reached if the GPU is more than
+ * @a UniformRing::kFrames frames behind.
+ */
+static constexpr GLuint64 kFenceTimeoutNs = 100 * 1000 * 1000;
+static constexpr int kFenceMaxWaits = 20;
+
+UniformRing::UniformRing(GLsizeiptr frameSize)
+        : buffer_(0),
+          frameSize_(0),
+          alignment_(256),
+          frame_(kFrames - 1),
+          fences_{},
+          mapped_(nullptr),
+          cursor_(0) {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment_);
+
+    // 每帧的起点也要满足对齐要求
+    frameSize_ = (frameSize + alignment_ - 1) / alignment_ * alignment_;
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, frameSize_ * kFrames, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    debug << "uniform ring: " << kFrames << " x " << frameSize_
+          << " bytes, alignment " << alignment_ << std::endl;
+}
+
+UniformRing::~UniformRing() {
+    if (mapped_) {
+        flush();
+    }
+    for (auto &fence: fences_) {
+        if (fence) glDeleteSync(fence);
+    }
+    glDeleteBuffers(1, &buffer_);
+}
+
+void UniformRing::beginFrame() {
+    frame_ = (frame_ + 1) % kFrames;
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    auto &fence = fences_[frame_];
+    if (fence) {
+        if (!_waitFence(fence)) {
+            // 无法确认GPU已经读完这段区域, 这一帧交给驱动同步
+            access &= ~GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    // 除非上面退回了同步映射, 围栏已经保证GPU不再读取这段区域, 因此可以不同步地映射
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    mapped_ = static_cast<uint8_t *>(glMapBufferRange(
+            GL_UNIFORM_BUFFER,
+            frame_ * frameSize_,
+            frameSize_,
+            access
+    ));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    cursor_ = 0;
+
+    if (!mapped_) {
+        warn << "uniform ring map failure" << std::endl;
+    }
+}
+
+bool UniformRing::_waitFence(GLsync fence) {
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (int wait = 0; wait < kFenceMaxWaits; ++wait) {
+        switch (glClientWaitSync(fence, flags, kFenceTimeoutNs)) {
+            case GL_ALREADY_SIGNALED:
+            case GL_CONDITION_SATISFIED:
+                return true;
+            case GL_TIMEOUT_EXPIRED:
+                if (wait == 0) {
+                    warn << "uniform ring fence timeout, still waiting" << std::endl;
+                }
+                // 第一次已经提交了命令, 之后不必再 flush
+                flags = 0;
+                break;
+            default:
+                warn << "uniform ring fence wait failure: " << glGetError() << std::endl;
+                return false;
+        }
+    }
+    warn << "uniform ring fence never signalled, mapping synchronized" << std::endl;
+    return false;
+}
+
+UniformRange UniformRing::_push(const void *data, size_t size) {
+    auto offset = (cursor_ + alignment_ - 1) / alignment_ * alignment_;
+    if (!mapped_ || offset + static_cast<GLsizeiptr>(size) > frameSize_) {
+        warn << "uniform ring overflow, frame size " << frameSize_ << std::endl;
+        return {0, 0};
+    }
+    std::memcpy(mapped_ + offset, data, size);
+    cursor_ = offset + size;
+    return {frame_ * frameSize_ + offset, static_cast<GLsizeiptr>(size)};
+}
+
+void UniformRing::flush() {
+    if (!mapped_) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    mapped_ = nullptr;
+}
+
+void UniformRing::_bind(GLuint binding, const UniformRange &range) const {
+    if (!range.size) return;
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer_, range.offset, range.size);
+}
+
+void UniformRing::endFrame() {
+    fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,144 @@
+#ifndef EGL_LEARNING_UNIFORMBUFFER_H
+#define EGL_LEARNING_UNIFORMBUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include <GLES3/gl3.h>
+#include "GlTrace.h"
+#include "Math.h"
+
+/*!
+ * Member types with std140 alignment baked in. A struct built only from these, plain
+ * float/int32_t/uint32_t scalars and arrays of Vec4/Mat4 has exactly the std140 layout, so it
+ * can be copied into a uniform buffer as is.
+ *
+ * There is deliberately no vec3: std140 packs a following scalar into its fourth component,
+ * which a 16-byte aligned C++ type cannot express. Use Vec4 instead.
+ */
+namespace std140 {
+
+    struct alignas(8) Vec2 {
+        float x, y;
+    };
+
+    struct alignas(16) Vec4 {
+        float x, y, z, w;
+
+        Vec4() = default;
+
+        constexpr Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+        constexpr Vec4(const ::Vec4 &v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
+
+        constexpr Vec4(const ::Vec3 &v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+    };
+
+    struct alignas(16) Mat4 {
+        float m[16];
+
+        Mat4() = default;
+
+        inline Mat4(const ::Mat4 &matrix) { std::memcpy(m, matrix.m, sizeof m); }
+    };
+
+    static_assert(sizeof(Vec2) == 8, "std140 vec2 is 8 bytes");
+    static_assert(sizeof(Vec4) == 16, "std140 vec4 is 16 bytes");
+    static_assert(sizeof(Mat4) == 64, "std140 mat4 is 4 vec4 columns");
+}
+
+/*!
+ * One member of a uniform block: its GLSL name and the byte offset of the matching C++ field
+ */
+struct UniformMember {
+    const char *name;
+    size_t offset;
+};
+
+/*!
+ * Specialize for every block struct (see UniformBlocks.h) with
+ *  - `static constexpr const char *kName`, the GLSL block name
+ *  - `static constexpr GLuint kBinding`, the binding point it is attached to
+ *  - `static constexpr UniformMember kMembers[]`, checked against program reflection by
+ *    @a Shader::bindUniformBlock()
+ */
+template<typename Block>
+struct UniformBlockTraits;
+
+/*!
+ * A slice of a @a UniformRing, ready for glBindBufferRange
+ */
+struct UniformRange {
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+/*!
+ * Per-frame uniform storage. One GL_UNIFORM_BUFFER is split into @a kFrames regions; each frame
+ * maps the next region unsynchronized, appends all of its blocks, and fences the region once
+ * the frame's draws are submitted. A region is only reused after its fence has signalled, so
+ * the CPU never writes data the GPU is still reading, and there is a single bulk upload per
+ * frame no matter how many blocks are written. If a fence cannot be waited on, that frame maps
+ * its region synchronized instead.
+ *
+ * Per frame: @a beginFrame(), any number of @a push(), @a flush(), binds and draws,
+ * @a endFrame().
+ */
+class UniformRing {
+public:
+    static constexpr int kFrames = 3;
+
+    /*!
+     * @param frameSize bytes available to each frame
+     */
+    explicit UniformRing(GLsizeiptr frameSize);
+
+    ~UniformRing();
+
+    UniformRing(const UniformRing &) = delete;
+
+    UniformRing &operator=(const UniformRing &) = delete;
+
+    void beginFrame();
+
+    /*!
+     * Appends @a block to the current frame.
+     * @return the range to bind, with size 0 when the frame region is full
+     */
+    template<typename Block>
+    UniformRange push(const Block &block) {
+        return _push(&block, sizeof(Block));
+    }
+
+    //! unmaps the frame region, must happen before any draw reads it
+    void flush();
+
+    template<typename Block>
+    void bind(const UniformRange &range) const {
+        _bind(UniformBlockTraits<Block>::kBinding, range);
+    }
+
+    //! fences the frame region, call after the last draw of the frame
+    void endFrame();
+
+private:
+    GLuint buffer_;
+    GLsizeiptr frameSize_;
+    GLint alignment_;
+    int frame_;
+    GLsync fences_[kFrames];
+    uint8_t *mapped_;
+    GLsizeiptr cursor_;
+
+    /*!
+     * Blocks until @a fence signals.
+     * @return false if the wait failed or timed out for good, the region may still be in use
+     */
+    static bool _waitFence(GLsync fence);
+
+    UniformRange _push(const void *data, size_t size);
+
+    void _bind(GLuint binding, const UniformRange &range) const;
+};
+
+
+#endif //EGL_LEARNING_UNIFORMBUFFER_H
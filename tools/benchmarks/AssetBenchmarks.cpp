@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "AssetFile.h"
+#include "Benchmark.h"
+#include "HostStubs.h"
+
+static void addTextAsset(const std::string &path, size_t size) {
+    const std::string line = "uniform mat4 uProjection; // padding to make a shader sized file\n";
+    std::vector<uint8_t> contents;
+    contents.reserve(size);
+    while (contents.size() < size) {
+        auto count = std::min(line.size(), size - contents.size());
+        contents.insert(contents.end(), line.begin(), line.begin() + count);
+    }
+    host::addAsset(path, std::move(contents));
+}
+
+// 着色器源码和粒子发射器配置都是几 KB 的文本
+BENCHMARK(readAssetFile_4KiB) {
+    addTextAsset("benchmark/shader.vert", 4 << 10);
+    std::string contents;
+
+    while (state.keepRunning()) {
+        readAssetFile(host::assetManager(), "benchmark/shader.vert", contents);
+        doNotOptimize(contents.data());
+    }
+    state.setBytesProcessed(contents.size());
+}
+
+BENCHMARK(readAssetFile_4KiB_fresh) {
+    addTextAsset("benchmark/shader.frag", 4 << 10);
+    size_t size = 0;
+
+    while (state.keepRunning()) {
+        std::string contents;
+        readAssetFile(host::assetManager(), "benchmark/shader.frag", contents);
+        doNotOptimize(contents.data());
+        size = contents.size();
+    }
+    state.setBytesProcessed(size);
+}
+
+BENCHMARK(readAssetFile_1MiB) {
+    addTextAsset("benchmark/large.txt", 1 << 20);
+    std::string contents;
+
+    while (state.keepRunning()) {
+        readAssetFile(host::assetManager(), "benchmark/large.txt", contents);
+        doNotOptimize(contents.data());
+    }
+    state.setBytesProcessed(contents.size());
+}
@@ -0,0 +1,165 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Registered {
+        const char *name;
+        BenchmarkFunction function;
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t iterations;
+        //! nanoseconds per iteration of every repetition, sorted
+        std::vector<double> samples;
+        size_t bytes;
+
+        double median() const {
+            auto middle = samples.size() / 2;
+            return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+        }
+    };
+
+    struct Options {
+        double minTime = 0.5;
+        int repetitions = 5;
+        const char *filter = nullptr;
+        const char *json = nullptr;
+        bool list = false;
+    };
+
+    std::vector<Registered> &registry() {
+        static std::vector<Registered> benchmarks;
+        return benchmarks;
+    }
+
+    double run(BenchmarkFunction function, uint64_t iterations, size_t &bytes) {
+        BenchmarkState state(iterations);
+        function(state);
+        bytes = state.bytesProcessed();
+        return std::chrono::duration<double>(state.elapsed()).count();
+    }
+
+    Result measure(const Registered &benchmark, const Options &options) {
+        // 先找出单次运行不短于 minTime 的迭代次数, 再用它重复测量
+        size_t bytes = 0;
+        uint64_t iterations = 1;
+        for (;;) {
+            auto seconds = run(benchmark.function, iterations, bytes);
+            if (seconds >= options.minTime || iterations >= (uint64_t(1) << 40)) {
+                break;
+            }
+            auto scale = seconds > 0 ? options.minTime * 1.4 / seconds : 100.0;
+            iterations = std::max(iterations + 1, uint64_t(double(iterations) * std::min(scale, 100.0)));
+        }
+
+        Result result{benchmark.name, iterations, {}, bytes};
+        for (int repetition = 0; repetition < options.repetitions; ++repetition) {
+            auto seconds = run(benchmark.function, iterations, bytes);
+            result.samples.push_back(seconds * 1e9 / double(iterations));
+        }
+        std::sort(result.samples.begin(), result.samples.end());
+        return result;
+    }
+
+    bool writeJson(const char *path, const std::vector<Result> &results, const Options &options) {
+        auto file = std::fopen(path, "w");
+        if (!file) {
+            std::fprintf(stderr, "cannot create %s\n", path);
+            return false;
+        }
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"build_type\": \"%s\",\n", BENCHMARK_BUILD_TYPE);
+        std::fprintf(file, "    \"compiler\": \"%s\",\n", __VERSION__);
+        std::fprintf(file, "    \"min_time\": %g,\n", options.minTime);
+        std::fprintf(file, "    \"repetitions\": %d\n  },\n", options.repetitions);
+        std::fprintf(file, "  \"benchmarks\": [");
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto &result = results[i];
+            auto median = result.median();
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, "
+                               "\"median_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, "
+                               "\"bytes_per_second\": %.0f}",
+                         i ? "," : "", result.name.c_str(),
+                         static_cast<unsigned long long>(result.iterations),
+                         median, result.samples.front(), result.samples.back(),
+                         result.bytes ? double(result.bytes) * 1e9 / median : 0.0);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    void printUsage(const char *program) {
+        std::fprintf(stderr, "usage: %s [--min-time seconds] [--repetitions n] [--filter substring] "
+                             "[--json path] [--list]\n", program);
+    }
+}
+
+bool registerBenchmark(const char *name, BenchmarkFunction function) {
+    registry().push_back({name, function});
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        auto hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--min-time") && hasValue) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--repetitions") && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--filter") && hasValue) {
+            options.filter = argv[++i];
+        } else if (!std::strcmp(argv[i], "--json") && hasValue) {
+            options.json = argv[++i];
+        } else if (!std::strcmp(argv[i], "--list")) {
+            options.list = true;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    auto benchmarks = registry();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const Registered &a, const Registered &b) {
+        return std::strcmp(a.name, b.name) < 0;
+    });
+    benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(), [&](const Registered &b) {
+        return options.filter && !std::strstr(b.name, options.filter);
+    }), benchmarks.end());
+
+    if (options.list) {
+        for (auto &benchmark: benchmarks) {
+            std::printf("%s\n", benchmark.name);
+        }
+        return 0;
+    }
+#if !defined(NDEBUG)
+    std::fprintf(stderr, "warning: benchmarks built without optimization, numbers are not comparable\n");
+#endif
+
+    std::vector<Result> results;
+    std::printf("%-36s %14s %14s %12s\n", "benchmark", "median ns/op", "iterations", "MB/s");
+    for (auto &benchmark: benchmarks) {
+        results.push_back(measure(benchmark, options));
+        auto &result = results.back();
+        std::printf("%-36s %14.1f %14llu", result.name.c_str(), result.median(),
+                    static_cast<unsigned long long>(result.iterations));
+        if (result.bytes) {
+            std::printf(" %12.1f", double(result.bytes) * 1e3 / result.median());
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    if (options.json && !writeJson(options.json, results, options)) {
+        return 1;
+    }
+    return 0;
+}
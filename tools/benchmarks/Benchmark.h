@@ -0,0 +1,83 @@
+#ifndef EGL_LEARNING_BENCHMARK_H
+#define EGL_LEARNING_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * Timing loop handed to every benchmark. Setup goes before the loop and is not timed:
+ *
+ *  BENCHMARK(example) {
+ *      auto data = makeData();
+ *      while (state.keepRunning()) {
+ *          doNotOptimize(process(data));
+ *      }
+ *      state.setBytesProcessed(data.size());
+ *  }
+ */
+class BenchmarkState {
+public:
+    explicit BenchmarkState(uint64_t iterations) : iterations_(iterations), remaining_(iterations) {}
+
+    //! starts the clock on the first call and stops it once the requested iterations ran
+    inline bool keepRunning() {
+        if (remaining_ == iterations_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+        if (remaining_ == 0) {
+            elapsed_ = std::chrono::steady_clock::now() - start_;
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+    //! bytes one iteration processes, reported as throughput
+    void setBytesProcessed(size_t bytes) {
+        bytes_ = bytes;
+    }
+
+    uint64_t iterations() const {
+        return iterations_;
+    }
+
+    size_t bytesProcessed() const {
+        return bytes_;
+    }
+
+    std::chrono::nanoseconds elapsed() const {
+        return elapsed_;
+    }
+
+private:
+    uint64_t iterations_;
+    uint64_t remaining_;
+    size_t bytes_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::nanoseconds elapsed_{0};
+};
+
+using BenchmarkFunction = void (*)(BenchmarkState &state);
+
+//! adds a benchmark to the suite, @a BENCHMARK() does this at static initialization
+bool registerBenchmark(const char *name, BenchmarkFunction function);
+
+//! keeps the compiler from dropping a computation whose result is otherwise unused
+template<typename T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//! makes the compiler assume all memory was read and written, so stores are not elided
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+#define BENCHMARK(name) \
+    static void benchmark_##name(BenchmarkState &state); \
+    static const bool registered_##name = registerBenchmark(#name, benchmark_##name); \
+    static void benchmark_##name(BenchmarkState &state)
+
+
+#endif //EGL_LEARNING_BENCHMARK_H
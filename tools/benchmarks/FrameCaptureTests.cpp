@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "FrameCapture.h"
+#include "HostGl.h"
+#include "HostStubs.h"
+#include "Test.h"
+
+namespace {
+
+constexpr GLint kWidth = 64;
+constexpr GLint kHeight = 64;
+
+//! the bottom-left quarter of the pattern, in GL's bottom-up coordinates
+constexpr GLint kQuarterWidth = kWidth / 2;
+constexpr GLint kQuarterHeight = kHeight / 4;
+
+constexpr uint8_t kBackground[] = {255, 0, 0, 255};
+constexpr uint8_t kQuarter[] = {0, 0, 255, 255};
+
+//! red with a blue bottom-left quarter, cleared without shaders so llvmpipe renders it exactly
+void drawPattern() {
+    glViewport(0, 0, kWidth, kHeight);
+    glClearColor(1, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, kQuarterWidth, kQuarterHeight);
+    glClearColor(0, 0, 1, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+}
+
+//! what @a drawPattern() should read back, bottom row first like @a ImageData
+ImageData goldenPattern() {
+    ImageData golden{kWidth, kHeight, size_t(kWidth) * 4, true, {}};
+    golden.pixels.resize(golden.stride * kHeight);
+    for (GLint y = 0; y < kHeight; ++y) {
+        for (GLint x = 0; x < kWidth; ++x) {
+            auto color = x < kQuarterWidth && y < kQuarterHeight ? kQuarter : kBackground;
+            std::copy(color, color + 4, golden.pixels.data() + y * golden.stride + x * 4);
+        }
+    }
+    return golden;
+}
+
+//! filled in by the consumer on a worker, the test thread waits on @a done
+struct CaptureResult {
+    CapturedFrame frame;
+    std::atomic<bool> done{false};
+};
+
+} // namespace
+
+// 读回走 capture()/poll() 的完整流程, 再和手工构造的标准图对比
+TEST(FrameCapture_compareWithGolden) {
+    auto result = std::make_shared<CaptureResult>();
+    HostGl gl;
+    CHECK(gl.valid());
+
+    JobSystem::Options options;
+    options.workerCount = 1;
+    JobSystem jobs(options);
+    FrameCapture capture(jobs);
+
+    drawPattern();
+    capture.request([result](const CapturedFrame &frame) {
+        result->frame = frame;
+        result->done.store(true, std::memory_order_release);
+    });
+    capture.capture(kWidth, kHeight);
+    CHECK(glGetError() == GL_NO_ERROR);
+
+    // poll() 从不等待, 栅栏发出信号前要一直轮询
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!result->done.load(std::memory_order_acquire)
+           && std::chrono::steady_clock::now() < deadline) {
+        glFlush();
+        capture.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(result->done.load(std::memory_order_acquire));
+
+    auto &frame = result->frame;
+    CHECK(frame.width == kWidth && frame.height == kHeight);
+    CHECK(frame.frame == 0);
+    CHECK(frame.pixels.size() == size_t(kWidth) * kHeight * 4);
+
+    auto golden = goldenPattern();
+    CHECK(FrameCapture::compare(frame, golden, 0) == 0);
+
+    // 一个像素的两个通道各差2, 只算一个像素, 容差2以内不算
+    auto nudged = golden;
+    nudged.pixels[0] += 2;
+    nudged.pixels[1] += 2;
+    auto last = nudged.pixels.size() - 4;
+    nudged.pixels[last] -= 1;
+    CHECK(FrameCapture::compare(frame, nudged, 0) == 2);
+    CHECK(FrameCapture::compare(frame, nudged, 1) == 1);
+    CHECK(FrameCapture::compare(frame, nudged, 2) == 0);
+
+    // 上下颠倒的图只有蓝色那块对不上
+    auto flipped = golden;
+    flipRows(golden.pixels.data(), flipped.pixels.data(), golden.stride, kHeight);
+    CHECK(FrameCapture::compare(frame, flipped, 0) == 2 * kQuarterWidth * kQuarterHeight);
+
+    ImageData narrow{kWidth / 2, kHeight, size_t(kWidth / 2) * 4, true, {}};
+    narrow.pixels.resize(narrow.stride * kHeight);
+    CHECK(FrameCapture::compare(frame, narrow, 255) == -1);
+    ImageData shorter{kWidth, kHeight - 1, size_t(kWidth) * 4, true, {}};
+    shorter.pixels.resize(shorter.stride * (kHeight - 1));
+    CHECK(FrameCapture::compare(frame, shorter, 255) == -1);
+}
+
+// writePng 翻转后编码, 解码再翻转回来应该和读回的一模一样
+TEST(FrameCapture_writePngRoundTrip) {
+    CapturedFrame frame{kWidth, kHeight, 7, {}};
+    frame.pixels = goldenPattern().pixels;
+
+    const char *path = "frame_capture_test.png";
+    CHECK(FrameCapture::writePng(frame, path));
+
+    auto file = std::fopen(path, "rb");
+    CHECK(file);
+    std::vector<uint8_t> contents;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof chunk, file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    std::remove(path);
+    host::addAsset("test/capture.png", std::move(contents));
+
+    auto decoded = Image::decode(host::assetManager(), "test/capture.png");
+    CHECK(decoded);
+    CHECK(FrameCapture::compare(frame, *decoded, 0) == 0);
+}
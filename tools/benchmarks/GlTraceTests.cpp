@@ -0,0 +1,129 @@
+// Built with EGL_GL_TRACE, so the GL calls below go through the recorder
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GlTrace.h"
+#include "GlTraceFormat.h"
+#include "HostGl.h"
+#include "Replayer.h"
+#include "Test.h"
+
+namespace {
+
+constexpr const char *kTracePath = "gl_trace_test.gltrace";
+constexpr const char *kReplayPath = "gl_trace_test_replay.gltrace";
+
+std::vector<uint8_t> readFile(const char *path) {
+    std::vector<uint8_t> contents;
+    auto file = std::fopen(path, "rb");
+    if (!file) return contents;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof chunk, file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    return contents;
+}
+
+bool writeFile(const char *path, const std::vector<uint8_t> &contents) {
+    auto file = std::fopen(path, "wb");
+    if (!file) return false;
+    auto written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    return std::fclose(file) == 0 && written;
+}
+
+//! byte offsets of the records of @a call in @a trace
+std::vector<size_t> findRecords(const std::vector<uint8_t> &trace, gltrace::Call call) {
+    std::vector<size_t> offsets;
+    auto offset = sizeof(gltrace::TraceHeader);
+    while (offset + sizeof(gltrace::RecordHeader) <= trace.size()) {
+        gltrace::RecordHeader header{};
+        std::memcpy(&header, trace.data() + offset, sizeof header);
+        if (header.call == call) offsets.push_back(offset);
+        offset += sizeof header + header.argCount * sizeof(uint64_t) + header.payloadSize;
+    }
+    return offsets;
+}
+
+gltrace::RecordHeader recordAt(const std::vector<uint8_t> &trace, size_t offset) {
+    gltrace::RecordHeader header{};
+    std::memcpy(&header, trace.data() + offset, sizeof header);
+    return header;
+}
+
+/*!
+ * Replays @a path and writes the executed calls to @a kReplayPath
+ * @return the executed calls, header included, empty if the replay could not start
+ */
+std::vector<uint8_t> replay(const char *path) {
+    Replayer replayer;
+    ReplayOptions options;
+    options.output = kReplayPath;
+    if (!replayer.load(path) || !replayer.createContext() || !replayer.run(options)) {
+        return {};
+    }
+    auto executed = readFile(kReplayPath);
+    std::remove(kReplayPath);
+    return executed;
+}
+
+} // namespace
+
+// 3x3 的 RGB 图每行 9 字节, 默认对齐 4 时补到 12, 对齐 1 时不补; 录制和回放必须算得一样
+TEST(GlTrace_texImagePayloadRoundTrip) {
+    {
+        HostGl gl;
+        CHECK(gl.valid());
+        CHECK(gltrace::start(kTracePath));
+        // 回放取第一帧的大小建表面, 先结束一个空帧, 后面的记录坏了也能开始回放
+        gltrace::frame(64, 64);
+
+        std::vector<uint8_t> pixels(12 * 3, 0x7f);
+        GLuint textures[2];
+        glGenTextures(2, textures);
+        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 3, 3, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, textures[1]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 3, 3, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        // 非法的对齐值 GL 不接受, 录制端也不能跟着改: 1x2 的 RGBA 仍是 8 字节, 不是 12
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 3);
+        glTexImage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glTexImage2D(GL_TEXTURE_2D, 2, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glDeleteTextures(2, textures);
+        gltrace::frame(64, 64);
+        gltrace::stop();
+    }
+
+    auto trace = readFile(kTracePath);
+    std::remove(kTracePath);
+    auto images = findRecords(trace, gltrace::kTexImage2D);
+    CHECK(images.size() == 4);
+    CHECK(recordAt(trace, images[0]).payloadSize == 36);
+    CHECK(recordAt(trace, images[1]).payloadSize == 27);
+    CHECK(recordAt(trace, images[2]).payloadSize == 8);
+    CHECK(recordAt(trace, images[3]).payloadSize == 0);
+
+    // 回放执行了每一条记录, 写出的就和录制的完全一样
+    CHECK(writeFile(kTracePath, trace));
+    auto executed = replay(kTracePath);
+    std::remove(kTracePath);
+    CHECK(executed == trace);
+
+    // 对齐 4 时 27 字节的负载不够, 回放要停在这条记录之前
+    auto corrupt = trace;
+    auto header = recordAt(corrupt, images[0]);
+    auto payload = images[0] + sizeof header + header.argCount * sizeof(uint64_t);
+    corrupt.erase(corrupt.begin() + payload + 27, corrupt.begin() + payload + 36);
+    header.payloadSize = 27;
+    std::memcpy(corrupt.data() + images[0], &header, sizeof header);
+    CHECK(writeFile(kTracePath, corrupt));
+    executed = replay(kTracePath);
+    std::remove(kTracePath);
+    CHECK(executed.size() == images[0]);
+    CHECK(std::equal(executed.begin(), executed.end(), corrupt.begin()));
+}
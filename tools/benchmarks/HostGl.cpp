@@ -0,0 +1,47 @@
+#include "HostGl.h"
+
+#include <cstdio>
+
+HostGl::HostGl() : display_(EGL_NO_DISPLAY), surface_(EGL_NO_SURFACE), context_(EGL_NO_CONTEXT) {
+    display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, nullptr, nullptr)) {
+        std::fprintf(stderr, "no EGL display\n");
+        display_ = EGL_NO_DISPLAY;
+        return;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    constexpr EGLint attributes[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display_, attributes, &config, 1, &configCount) || !configCount) {
+        std::fprintf(stderr, "no GLES 3 pbuffer config\n");
+        return;
+    }
+
+    constexpr EGLint surfaceAttributes[] = {EGL_WIDTH, 64, EGL_HEIGHT, 64, EGL_NONE};
+    surface_ = eglCreatePbufferSurface(display_, config, surfaceAttributes);
+    constexpr EGLint contextAttributes[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    auto context = eglCreateContext(display_, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display_, surface_, surface_, context)) {
+        std::fprintf(stderr, "GLES 3 context creation failure: 0x%x\n", eglGetError());
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display_, context);
+        return;
+    }
+    context_ = context;
+}
+
+HostGl::~HostGl() {
+    if (display_ == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context_ != EGL_NO_CONTEXT) eglDestroyContext(display_, context_);
+    if (surface_ != EGL_NO_SURFACE) eglDestroySurface(display_, surface_);
+    eglTerminate(display_);
+}
@@ -0,0 +1,30 @@
+#ifndef EGL_LEARNING_HOSTGL_H
+#define EGL_LEARNING_HOSTGL_H
+
+#include <EGL/egl.h>
+
+/*!
+ * Headless GLES 3 context for host tests, on a small pbuffer. With Mesa, run with
+ * EGL_PLATFORM=surfaceless to get llvmpipe without a display (ctest sets it).
+ */
+class HostGl {
+public:
+    HostGl();
+
+    ~HostGl();
+
+    HostGl(const HostGl &) = delete;
+
+    HostGl &operator=(const HostGl &) = delete;
+
+    //! false if no context could be made current, the failure has been printed
+    inline bool valid() const { return context_ != EGL_NO_CONTEXT; }
+
+private:
+    EGLDisplay display_;
+    EGLSurface surface_;
+    EGLContext context_;
+};
+
+
+#endif //EGL_LEARNING_HOSTGL_H
@@ -0,0 +1,187 @@
+#include "HostStubs.h"
+
+#include <android/asset_manager.h>
+#include <android/bitmap.h>
+#include <android/imagedecoder.h>
+#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+    struct RawImageHeader {
+        int32_t width;
+        int32_t height;
+        int32_t opaque;
+    };
+
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<uint8_t>>> assets;
+
+    //! JobSystem workers log too, e.g. in egl_tests
+    std::atomic<size_t> logged{0};
+}
+
+struct AAsset {
+    std::shared_ptr<const std::vector<uint8_t>> contents;
+    size_t position;
+};
+
+struct AImageDecoder {
+    AAsset *asset;
+    RawImageHeader header;
+};
+
+void host::addAsset(const std::string &path, std::vector<uint8_t> contents) {
+    assets[path] = std::make_shared<const std::vector<uint8_t>>(std::move(contents));
+}
+
+void host::addImageAsset(const std::string &path, int32_t width, int32_t height, bool opaque) {
+    RawImageHeader header{width, height, opaque};
+    std::vector<uint8_t> contents(sizeof(header) + size_t(width) * height * 4);
+    std::memcpy(contents.data(), &header, sizeof(header));
+    // 每行内容不同, 翻转写错了对比得出来
+    for (size_t i = sizeof(header); i < contents.size(); ++i) {
+        contents[i] = static_cast<uint8_t>(i * 31 + i / (size_t(width) * 4));
+    }
+    addAsset(path, std::move(contents));
+}
+
+size_t host::loggedBytes() {
+    return logged.load(std::memory_order_relaxed);
+}
+
+extern "C" {
+
+AAsset *AAssetManager_open(AAssetManager *, const char *filename, int) {
+    auto found = assets.find(filename);
+    if (found == assets.end()) {
+        return nullptr;
+    }
+    return new AAsset{found->second, 0};
+}
+
+int AAsset_read(AAsset *asset, void *buf, size_t count) {
+    count = std::min(count, asset->contents->size() - asset->position);
+    std::memcpy(buf, asset->contents->data() + asset->position, count);
+    asset->position += count;
+    return static_cast<int>(count);
+}
+
+off_t AAsset_getLength(AAsset *asset) {
+    return static_cast<off_t>(asset->contents->size());
+}
+
+const void *AAsset_getBuffer(AAsset *asset) {
+    return asset->contents->data();
+}
+
+void AAsset_close(AAsset *asset) {
+    delete asset;
+}
+
+int AImageDecoder_createFromAAsset(AAsset *asset, AImageDecoder **outDecoder) {
+    RawImageHeader header{};
+    if (asset->contents->size() < sizeof(header)) {
+        return ANDROID_IMAGE_DECODER_INVALID_INPUT;
+    }
+    std::memcpy(&header, asset->contents->data(), sizeof(header));
+    *outDecoder = new AImageDecoder{asset, header};
+    return ANDROID_IMAGE_DECODER_SUCCESS;
+}
+
+void AImageDecoder_delete(AImageDecoder *decoder) {
+    delete decoder;
+}
+
+int AImageDecoder_setAndroidBitmapFormat(AImageDecoder *, int32_t format) {
+    return format == ANDROID_BITMAP_FORMAT_RGBA_8888
+           ? ANDROID_IMAGE_DECODER_SUCCESS
+           : ANDROID_IMAGE_DECODER_BAD_PARAMETER;
+}
+
+const AImageDecoderHeaderInfo *AImageDecoder_getHeaderInfo(const AImageDecoder *decoder) {
+    return reinterpret_cast<const AImageDecoderHeaderInfo *>(&decoder->header);
+}
+
+int32_t AImageDecoderHeaderInfo_getWidth(const AImageDecoderHeaderInfo *info) {
+    return reinterpret_cast<const RawImageHeader *>(info)->width;
+}
+
+int32_t AImageDecoderHeaderInfo_getHeight(const AImageDecoderHeaderInfo *info) {
+    return reinterpret_cast<const RawImageHeader *>(info)->height;
+}
+
+int AImageDecoderHeaderInfo_getAlphaFlags(const AImageDecoderHeaderInfo *info) {
+    return reinterpret_cast<const RawImageHeader *>(info)->opaque
+           ? ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE
+           : ANDROID_BITMAP_FLAGS_ALPHA_PREMUL;
+}
+
+size_t AImageDecoder_getMinimumStride(AImageDecoder *decoder) {
+    return size_t(decoder->header.width) * 4;
+}
+
+int AImageDecoder_decodeImage(AImageDecoder *decoder, void *pixels, size_t stride, size_t size) {
+    auto rowSize = size_t(decoder->header.width) * 4;
+    auto height = size_t(decoder->header.height);
+    if (stride < rowSize || size < stride * (height - 1) + rowSize) {
+        return ANDROID_IMAGE_DECODER_BAD_PARAMETER;
+    }
+    auto source = decoder->asset->contents->data() + sizeof(RawImageHeader);
+    for (size_t y = 0; y < height; ++y) {
+        std::memcpy(static_cast<uint8_t *>(pixels) + y * stride, source + y * rowSize, rowSize);
+    }
+    return ANDROID_IMAGE_DECODER_SUCCESS;
+}
+
+// 写出和解码器相同的原始格式, 截图可以再当作资源解码回来
+int AndroidBitmap_compress(const AndroidBitmapInfo *info, int32_t, const void *pixels, int32_t,
+                           int32_t, void *userContext, AndroidBitmap_CompressWriteFunc fn) {
+    auto rowSize = size_t(info->width) * 4;
+    if (info->format != ANDROID_BITMAP_FORMAT_RGBA_8888 || info->stride < rowSize) {
+        return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+    }
+    RawImageHeader header{int32_t(info->width), int32_t(info->height),
+                          info->flags == ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE};
+    if (!fn(userContext, &header, sizeof(header))) {
+        return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+    }
+    for (size_t y = 0; y < info->height; ++y) {
+        if (!fn(userContext, static_cast<const uint8_t *>(pixels) + y * info->stride, rowSize)) {
+            return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+        }
+    }
+    return ANDROID_BITMAP_RESULT_SUCCESS;
+}
+
+// logcat 只计数不输出, 量的是 AndroidOut 自己的开销
+int __android_log_write(int, const char *, const char *text) {
+    logged.fetch_add(std::strlen(text), std::memory_order_relaxed);
+    return 1;
+}
+
+int __android_log_print(int, const char *, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    auto length = std::vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+    logged.fetch_add(std::max(length, 0), std::memory_order_relaxed);
+    return 1;
+}
+
+void __android_log_assert(const char *, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    std::fprintf(stderr, "%s: ", tag);
+    std::vfprintf(stderr, fmt, args);
+    std::fputc('\n', stderr);
+    va_end(args);
+    std::abort();
+}
+
+}
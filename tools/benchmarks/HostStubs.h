@@ -0,0 +1,36 @@
+#ifndef EGL_LEARNING_HOSTSTUBS_H
+#define EGL_LEARNING_HOSTSTUBS_H
+
+#include <android/asset_manager.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * Host implementations of the NDK calls the benchmarked app sources make: assets live in memory,
+ * images are stored raw (AndroidBitmap_compress writes the same format) and logcat is a sink
+ * that only counts.
+ */
+namespace host {
+
+    //! registers an asset under @a path, replacing any earlier one
+    void addAsset(const std::string &path, std::vector<uint8_t> contents);
+
+    /*!
+     * Registers a raw RGBA image the stub AImageDecoder understands: a width and height header
+     * followed by tightly packed rows, top row first like a decoded PNG.
+     */
+    void addImageAsset(const std::string &path, int32_t width, int32_t height, bool opaque);
+
+    //! bytes written to logcat since start up
+    size_t loggedBytes();
+
+    //! the asset manager to pass to app code, the stubs ignore it
+    inline AAssetManager *assetManager() {
+        return nullptr;
+    }
+}
+
+
+#endif //EGL_LEARNING_HOSTSTUBS_H
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Benchmark.h"
+#include "HostStubs.h"
+#include "Image.h"
+
+// 读回一帧 1080p 截图时 writePng 翻转的量
+BENCHMARK(flipRows_1920x1080) {
+    const int32_t width = 1920;
+    const int32_t height = 1080;
+    const size_t stride = size_t(width) * 4;
+    std::vector<uint8_t> source(stride * height);
+    std::vector<uint8_t> destination(source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<uint8_t>(i / stride);
+    }
+
+    while (state.keepRunning()) {
+        flipRows(source.data(), destination.data(), stride, height);
+        clobberMemory();
+    }
+    state.setBytesProcessed(source.size());
+
+    if (std::memcmp(destination.data(), source.data() + (height - 1) * stride, stride) != 0) {
+        std::fprintf(stderr, "flipRows: first row is not the last source row\n");
+        std::abort();
+    }
+}
+
+// Image::load 的 CPU 部分: 打开资源, 解码到临时缓冲, 再翻转到 GL 的行序
+BENCHMARK(imageDecode_1024x1024) {
+    const int32_t size = 1024;
+    host::addImageAsset("benchmark/image.raw", size, size, false);
+
+    while (state.keepRunning()) {
+        auto data = Image::decode(host::assetManager(), "benchmark/image.raw");
+        doNotOptimize(data->pixels.data());
+    }
+    state.setBytesProcessed(size_t(size) * size * 4);
+}
+
+BENCHMARK(imageDecode_256x256) {
+    const int32_t size = 256;
+    host::addImageAsset("benchmark/sprite.raw", size, size, true);
+
+    while (state.keepRunning()) {
+        auto data = Image::decode(host::assetManager(), "benchmark/sprite.raw");
+        doNotOptimize(data->pixels.data());
+    }
+    state.setBytesProcessed(size_t(size) * size * 4);
+}
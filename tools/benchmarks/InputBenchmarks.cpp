@@ -0,0 +1,51 @@
+#include <android/input.h>
+#include <android/keycodes.h>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "Input.h"
+
+static void setPointer(GameActivityPointerAxes &pointer, int32_t id, float x, float y) {
+    pointer.id = id;
+    pointer.axisValues[AMOTION_EVENT_AXIS_X] = x;
+    pointer.axisValues[AMOTION_EVENT_AXIS_Y] = y;
+}
+
+// 一帧里满载的输入缓冲: 两指拖动的 MOVE 事件加上几个按键
+BENCHMARK(processInput_fullBuffer) {
+    static android_input_buffer inputBuffer;
+    std::memset(&inputBuffer, 0, sizeof(inputBuffer));
+    inputBuffer.motionEventsCount = NATIVE_APP_GLUE_MAX_NUM_MOTION_EVENTS;
+    for (auto i = 0; i < NATIVE_APP_GLUE_MAX_NUM_MOTION_EVENTS; ++i) {
+        auto &motionEvent = inputBuffer.motionEvents[i];
+        motionEvent.action = AMOTION_EVENT_ACTION_MOVE;
+        motionEvent.pointerCount = 2;
+        setPointer(motionEvent.pointers[0], 0, 100.5f + i, 200.25f);
+        setPointer(motionEvent.pointers[1], 1, 300.75f, 400.5f - i);
+    }
+    inputBuffer.keyEventsCount = NATIVE_APP_GLUE_MAX_NUM_KEY_EVENTS;
+    for (auto i = 0; i < NATIVE_APP_GLUE_MAX_NUM_KEY_EVENTS; ++i) {
+        auto &keyEvent = inputBuffer.keyEvents[i];
+        keyEvent.action = i % 2 ? AKEY_EVENT_ACTION_UP : AKEY_EVENT_ACTION_DOWN;
+        keyEvent.keyCode = AKEYCODE_D;
+    }
+
+    while (state.keepRunning()) {
+        doNotOptimize(processInput(inputBuffer));
+    }
+}
+
+BENCHMARK(processInput_tap) {
+    static android_input_buffer inputBuffer;
+    std::memset(&inputBuffer, 0, sizeof(inputBuffer));
+    inputBuffer.motionEventsCount = 2;
+    inputBuffer.motionEvents[0].action = AMOTION_EVENT_ACTION_DOWN;
+    inputBuffer.motionEvents[0].pointerCount = 1;
+    setPointer(inputBuffer.motionEvents[0].pointers[0], 0, 540.0f, 960.0f);
+    inputBuffer.motionEvents[1] = inputBuffer.motionEvents[0];
+    inputBuffer.motionEvents[1].action = AMOTION_EVENT_ACTION_UP;
+
+    while (state.keepRunning()) {
+        doNotOptimize(processInput(inputBuffer));
+    }
+}
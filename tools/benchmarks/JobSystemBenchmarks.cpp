@@ -0,0 +1,58 @@
+#include <cmath>
+#include <vector>
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+/*!
+ * parallelFor over a transform-like kernel with @a Threads threads taking part, the caller plus
+ * Threads - 1 workers. Compare the results across thread counts to see how the scheduler scales.
+ */
+template<int Threads>
+static void parallelForScaling(BenchmarkState &state) {
+    JobSystem::Options options;
+    options.workerCount = Threads - 1;
+    JobSystem jobs(options);
+
+    std::vector<float> values(1 << 18);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = float(i) * 0.001f;
+    }
+    auto kernel = [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            auto value = values[i];
+            values[i] = std::sin(value) * 0.5f + std::cos(value * 0.25f) * 0.5f + value;
+        }
+    };
+
+    while (state.keepRunning()) {
+        jobs.parallelFor(0, values.size(), 1024, kernel);
+        clobberMemory();
+    }
+    state.setBytesProcessed(values.size() * sizeof(float));
+}
+
+// 名字固定下来, 不同机器上的结果才能互相比较
+static const bool registeredScaling[] = {
+        registerBenchmark("jobSystem_parallelFor_threads1", parallelForScaling<1>),
+        registerBenchmark("jobSystem_parallelFor_threads2", parallelForScaling<2>),
+        registerBenchmark("jobSystem_parallelFor_threads4", parallelForScaling<4>),
+        registerBenchmark("jobSystem_parallelFor_threads8", parallelForScaling<8>),
+};
+
+// 一次 run + wait 的调度开销
+BENCHMARK(jobSystem_runWait) {
+    JobSystem::Options options;
+    options.workerCount = 1;
+    JobSystem jobs(options);
+    int value = 0;
+
+    while (state.keepRunning()) {
+        JobCounter counter;
+        jobs.run([](void *data, size_t, size_t) {
+            ++*static_cast<int *>(data);
+        }, &value, 0, 1, &counter);
+        jobs.wait(counter);
+    }
+    doNotOptimize(value);
+}
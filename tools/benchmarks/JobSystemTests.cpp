@@ -0,0 +1,273 @@
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Test.h"
+
+// 主线程当所有者不停 push/pop, 其余线程同时偷取, 每个任务必须恰好被取走一次
+TEST(WorkStealingQueue_pushPopStealRace) {
+    const size_t jobCount = 200000;
+    const int stealerCount = 3;
+    auto queue = std::make_unique<WorkStealingQueue>();
+    std::vector<Job> jobs(jobCount);
+    std::unique_ptr<std::atomic<int>[]> taken(new std::atomic<int>[jobCount]);
+    for (size_t i = 0; i < jobCount; ++i) taken[i].store(0);
+    std::atomic<size_t> takenCount{0};
+
+    auto take = [&](Job *job) {
+        taken[job - jobs.data()].fetch_add(1);
+        takenCount.fetch_add(1);
+    };
+
+    std::vector<std::thread> stealers;
+    for (int i = 0; i < stealerCount; ++i) {
+        stealers.emplace_back([&] {
+            while (takenCount.load() < jobCount) {
+                if (auto job = queue->steal()) {
+                    take(job);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // 一批批 push, 每批之后 pop 掉一部分, 让 pop 和 steal 在队列快空时竞争最后一个元素
+    size_t pushed = 0;
+    for (size_t batch = 1; pushed < jobCount; batch = batch % 61 + 1) {
+        for (size_t i = 0; i < batch && pushed < jobCount; ++i) {
+            if (!queue->push(&jobs[pushed])) break;
+            ++pushed;
+        }
+        for (size_t i = 0; i < batch / 2; ++i) {
+            if (auto job = queue->pop()) take(job);
+        }
+    }
+    while (takenCount.load() < jobCount) {
+        if (auto job = queue->pop()) {
+            take(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &stealer: stealers) stealer.join();
+
+    CHECK(takenCount.load() == jobCount);
+    CHECK(queue->pop() == nullptr);
+    CHECK(queue->steal() == nullptr);
+    for (size_t i = 0; i < jobCount; ++i) {
+        CHECK(taken[i].load() == 1);
+    }
+}
+
+TEST(WorkStealingQueue_capacity) {
+    auto queue = std::make_unique<WorkStealingQueue>();
+    Job job{};
+    for (size_t i = 0; i < WorkStealingQueue::kCapacity; ++i) {
+        CHECK(queue->push(&job));
+    }
+    CHECK(queue->full());
+    CHECK(!queue->push(&job));
+    CHECK(queue->steal() == &job);
+    CHECK(!queue->full());
+    CHECK(queue->push(&job));
+}
+
+TEST(JobSystem_counterCompletion) {
+    JobSystem::Options options;
+    options.workerCount = 3;
+    JobSystem jobs(options);
+    CHECK(jobs.workerCount() == 3);
+
+    std::atomic<int> sum{0};
+    JobCounter counter;
+    CHECK(counter.done());
+    for (int i = 0; i < 1000; ++i) {
+        jobs.run([](void *data, size_t begin, size_t end) {
+            static_cast<std::atomic<int> *>(data)->fetch_add(int(end - begin));
+        }, &sum, 0, 1, &counter);
+    }
+    jobs.wait(counter);
+    CHECK(counter.done());
+    CHECK(sum.load() == 1000);
+}
+
+struct Refill {
+    JobSystem *jobs;
+    std::vector<std::atomic<int>> ran;
+    std::atomic<int> children{0};
+    JobCounter childCounter;
+};
+
+// 填满记录池后, 所有者 LIFO 弹出一个任务, 任务里马上再提交: 新任务不能覆盖还在队列里的旧记录
+TEST(JobSystem_recordReuseAfterFill) {
+    for (int workerCount: {0, 3}) {
+        JobSystem::Options options;
+        options.workerCount = workerCount;
+        JobSystem jobs(options);
+        const size_t count = WorkStealingQueue::kCapacity;
+        Refill refill;
+        refill.jobs = &jobs;
+        refill.ran = std::vector<std::atomic<int>>(count);
+
+        JobCounter counter;
+        for (size_t i = 0; i < count; ++i) {
+            jobs.run([](void *data, size_t index, size_t) {
+                auto refill = static_cast<Refill *>(data);
+                refill->ran[index].fetch_add(1);
+                for (int child = 0; child < 2; ++child) {
+                    refill->jobs->run([](void *data, size_t, size_t) {
+                        static_cast<Refill *>(data)->children.fetch_add(1);
+                    }, refill, 0, 1, &refill->childCounter);
+                }
+            }, &refill, i, i + 1, &counter);
+        }
+        jobs.wait(counter);
+        jobs.wait(refill.childCounter);
+
+        CHECK(counter.done());
+        CHECK(refill.childCounter.done());
+        CHECK(refill.children.load() == int(count) * 2);
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(refill.ran[i].load() == 1);
+        }
+    }
+}
+
+struct Stages {
+    JobSystem *jobs;
+    std::vector<int> values;
+    std::vector<int> doubled;
+    std::atomic<int> childrenDone{0};
+};
+
+// 第二阶段依赖第一阶段的结果; 任务里还会再派生子任务并在工作线程上等待它们
+TEST(JobSystem_dependencies) {
+    JobSystem::Options options;
+    options.workerCount = 3;
+    JobSystem jobs(options);
+    Stages stages{&jobs, std::vector<int>(256, 0), std::vector<int>(256, 0)};
+
+    JobCounter first;
+    for (size_t i = 0; i < stages.values.size(); ++i) {
+        jobs.run([](void *data, size_t begin, size_t) {
+            static_cast<Stages *>(data)->values[begin] = int(begin) + 1;
+        }, &stages, i, i + 1, &first);
+    }
+    jobs.wait(first);
+
+    JobCounter second;
+    for (size_t i = 0; i < stages.values.size(); i += 16) {
+        jobs.run([](void *data, size_t begin, size_t end) {
+            auto stages = static_cast<Stages *>(data);
+            JobCounter children;
+            for (auto i = begin; i < end; ++i) {
+                stages->jobs->run([](void *data, size_t index, size_t) {
+                    auto stages = static_cast<Stages *>(data);
+                    stages->doubled[index] = stages->values[index] * 2;
+                    stages->childrenDone.fetch_add(1);
+                }, stages, i, i + 1, &children);
+            }
+            stages->jobs->wait(children);
+        }, &stages, i, i + 16, &second);
+    }
+    jobs.wait(second);
+
+    CHECK(stages.childrenDone.load() == 256);
+    for (size_t i = 0; i < stages.doubled.size(); ++i) {
+        CHECK(stages.doubled[i] == int(i + 1) * 2);
+    }
+}
+
+TEST(JobSystem_parallelForCoverage) {
+    JobSystem::Options options;
+    options.workerCount = 3;
+    JobSystem jobs(options);
+
+    struct Case {
+        size_t begin;
+        size_t end;
+        size_t grain;
+    };
+    // 空区间, 单个元素, 不整除, 以及任务数超过上限需要放大粒度的情况
+    const Case cases[] = {
+            {0, 0, 1}, {5, 5, 4}, {7, 3, 1}, {0, 1, 1}, {3, 10, 4},
+            {0, 1000, 7}, {10, 1010, 1000}, {0, 100000, 1}, {17, 50017, 0},
+    };
+    for (auto &range: cases) {
+        auto size = range.end > range.begin ? range.end : range.begin;
+        std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[size + 1]);
+        for (size_t i = 0; i <= size; ++i) hits[i].store(0);
+
+        std::atomic<bool> badRange{false};
+        jobs.parallelFor(range.begin, range.end, range.grain, [&](size_t begin, size_t end) {
+            if (begin >= end || begin < range.begin || end > range.end) badRange.store(true);
+            for (auto i = begin; i < end; ++i) hits[i].fetch_add(1);
+        });
+
+        CHECK(!badRange.load());
+        for (size_t i = 0; i <= size; ++i) {
+            auto inside = i >= range.begin && i < range.end;
+            CHECK(hits[i].load() == (inside ? 1 : 0));
+        }
+    }
+}
+
+static double processCpuSeconds() {
+    timespec time{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return double(time.tv_sec) + double(time.tv_nsec) * 1e-9;
+}
+
+// 空闲的工作线程必须睡在条件变量上, 不能空转
+TEST(JobSystem_idleWithoutSpinning) {
+    JobSystem::Options options;
+    options.workerCount = 4;
+    JobSystem jobs(options);
+
+    std::atomic<int> sum{0};
+    jobs.parallelFor(0, 4096, 16, [&](size_t begin, size_t end) {
+        sum.fetch_add(int(end - begin));
+    });
+    CHECK(sum.load() == 4096);
+
+    std::atomic<bool> backgroundDone{false};
+    jobs.runBackground([](void *data, size_t, size_t) {
+        static_cast<std::atomic<bool> *>(data)->store(true);
+    }, &backgroundDone);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!backgroundDone.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(backgroundDone.load());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto cpuBefore = processCpuSeconds();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    auto cpuUsed = processCpuSeconds() - cpuBefore;
+    // 4个空转的线程会用掉接近 4 * 300ms
+    CHECK(cpuUsed < 0.03);
+}
+
+TEST(JobSystem_coreClusters) {
+    // prime + big + little
+    const std::vector<long> phone = {2000, 2000, 2000, 2000, 2800, 2800, 2800, 3200};
+    CHECK(JobSystem::coreCount(CoreAffinity::kBig, phone) == 4);
+    CHECK(JobSystem::coreCount(CoreAffinity::kLittle, phone) == 4);
+    CHECK(JobSystem::coreCount(CoreAffinity::kAny, phone) == 8);
+
+    const std::vector<long> bigLittle = {1800, 1800, 1800, 1800, 2400, 2400, 2400, 2400};
+    CHECK(JobSystem::coreCount(CoreAffinity::kBig, bigLittle) == 4);
+    CHECK(JobSystem::coreCount(CoreAffinity::kLittle, bigLittle) == 4);
+
+    // 对称CPU, 或者内核不提供频率
+    const std::vector<long> symmetric = {3000, 3000, 3000, 3000};
+    CHECK(JobSystem::coreCount(CoreAffinity::kBig, symmetric) == 4);
+    CHECK(JobSystem::coreCount(CoreAffinity::kLittle, symmetric) == 0);
+    const std::vector<long> unknown = {0, 0};
+    CHECK(JobSystem::coreCount(CoreAffinity::kBig, unknown) == 2);
+}
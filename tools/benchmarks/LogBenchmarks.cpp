@@ -0,0 +1,32 @@
+#include <string>
+
+#include "AndroidOut.h"
+#include "Benchmark.h"
+#include "HostStubs.h"
+
+// 每帧统计那种短日志
+BENCHMARK(debugLine_short) {
+    auto before = host::loggedBytes();
+    uint64_t frame = 0;
+
+    while (state.keepRunning()) {
+        debug << "frame " << frame++ << " took " << 16.6f << " ms" << std::endl;
+    }
+    state.setBytesProcessed(frame ? (host::loggedBytes() - before) / frame : 0);
+}
+
+// 着色器源码那种多行长日志, 超过缓冲要在换行处拆开
+BENCHMARK(debugLine_long) {
+    std::string source;
+    while (source.size() < 3000) {
+        source += "    gl_Position = uProjection * vec4(inPosition, 1.0);\n";
+    }
+    auto before = host::loggedBytes();
+    uint64_t lines = 0;
+
+    while (state.keepRunning()) {
+        debug << "vertex source: " << std::endl << source << std::endl;
+        ++lines;
+    }
+    state.setBytesProcessed(lines ? (host::loggedBytes() - before) / lines : 0);
+}
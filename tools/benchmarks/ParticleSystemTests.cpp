@@ -0,0 +1,119 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "HostGl.h"
+#include "HostStubs.h"
+#include "ParticleSystem.h"
+#include "Test.h"
+#include "UniformBuffer.h"
+
+//! copies an app asset from the source tree into the in-memory asset registry
+static bool addAppAsset(const std::string &path) {
+    auto file = std::fopen((std::string(APP_ASSET_DIR "/") + path).c_str(), "rb");
+    if (!file) {
+        std::fprintf(stderr, "missing app asset %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> contents;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof chunk, file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    host::addAsset(path, std::move(contents));
+    return true;
+}
+
+static void addTextAsset(const std::string &path, const std::string &text) {
+    host::addAsset(path, std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+// 小发射器模拟几秒, 读回变换反馈写出的缓冲检查粒子数量和范围
+TEST(ParticleSystem_simulateHeadless) {
+    HostGl gl;
+    CHECK(gl.valid());
+
+    for (auto shader: {"shader/particle_update_vertex.glsl", "shader/particle_update_fragment.glsl",
+                       "shader/particle_render_vertex.glsl", "shader/particle_render_fragment.glsl"}) {
+        CHECK(addAppAsset(shader));
+    }
+    host::addImageAsset("test/particle.raw", 8, 8, false);
+    addTextAsset("test/small.emitter",
+                 "count = 4096\n"
+                 "position = 0.5 -1 0\n"
+                 "direction = 0 1 0\n"
+                 "spread = 0.5\n"
+                 "speedMin = 1\n"
+                 "speedMax = 2\n"
+                 "lifetimeMin = 0.5\n"
+                 "lifetimeMax = 1.5\n"
+                 "gravity = 0.25 -2 0\n"
+                 "image = test/particle.raw\n");
+
+    auto particles = ParticleSystem::load(host::assetManager(), "test/small.emitter");
+    CHECK(particles);
+    auto &params = particles->params();
+    CHECK(params.count == 4096);
+
+    UniformRing uniforms(1024);
+    CameraBlock camera{};
+    camera.viewProjection = Mat4::identity();
+    camera.viewRect = std140::Vec4(-4, -4, 4, 4);
+    camera.deltaTime = 1.f / 30.f;
+    camera.resolutionScale = 1;
+    const int steps = 90;
+    for (int step = 0; step < steps; ++step) {
+        camera.time = float(step) * camera.deltaTime;
+        uniforms.beginFrame();
+        auto cameraRange = uniforms.push(camera);
+        particles->pushUniforms(uniforms);
+        uniforms.flush();
+        uniforms.bind<CameraBlock>(cameraRange);
+        particles->update(uniforms);
+        uniforms.endFrame();
+    }
+    CHECK(glGetError() == GL_NO_ERROR);
+
+    glBindBuffer(GL_ARRAY_BUFFER, particles->stateBuffer());
+    GLint size = 0;
+    glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+    CHECK(size == GLint(params.count * 8 * sizeof(float)));
+    auto state = static_cast<const float *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_READ_BIT));
+    CHECK(state);
+
+    // 模拟了3秒, 超过最长寿命, 所有粒子至少出生过一次
+    auto bounds = particles->bounds();
+    const float epsilon = 1e-3f;
+    int alive = 0;
+    int outside = 0;
+    int invalid = 0;
+    for (GLsizei i = 0; i < params.count; ++i) {
+        auto particle = state + i * 8;
+        auto x = particle[0], y = particle[1], age = particle[3], lifetime = particle[7];
+        bool finite = true;
+        for (int component = 0; component < 8; ++component) {
+            finite = finite && std::isfinite(particle[component]);
+        }
+        if (!finite || age < 0 || age > lifetime
+            || lifetime < params.lifetimeMin - epsilon || lifetime > params.lifetimeMax + epsilon) {
+            ++invalid;
+            continue;
+        }
+        ++alive;
+        if (x < bounds.left - epsilon || x > bounds.right + epsilon
+            || y < bounds.bottom - epsilon || y > bounds.top + epsilon) {
+            ++outside;
+        }
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (invalid || outside) {
+        std::fprintf(stderr, "%d particles invalid, %d outside the bounds\n", invalid, outside);
+    }
+    CHECK(alive == params.count);
+    CHECK(outside == 0);
+}
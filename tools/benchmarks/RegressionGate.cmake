@@ -0,0 +1,11 @@
+# Runs the full suite and compares it with the baseline, see CMakeLists.txt.
+execute_process(COMMAND ${BENCHMARK} --json current.json RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "benchmarks failed: ${result}")
+endif ()
+
+execute_process(COMMAND ${PYTHON} ${COMPARE} ${BASELINE} current.json --threshold ${THRESHOLD}
+        RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "performance regression against ${BASELINE}")
+endif ()
@@ -0,0 +1,74 @@
+#include <cmath>
+
+#include "DynamicResolution.h"
+#include "Test.h"
+
+namespace {
+
+ResolutionSettings testSettings() {
+    ResolutionSettings settings;
+    settings.raiseDelay = 5;
+    settings.settleFrames = 0;
+    return settings;
+}
+
+} // namespace
+
+// 只有GPU超时才降低分辨率
+TEST(ResolutionController_gpuOverTargetLowersScale) {
+    auto settings = testSettings();
+    ResolutionController controller(settings);
+    auto scale = controller.update(settings.targetFrameTime * 2, settings.targetFrameTime / 2);
+    CHECK(scale < settings.maxScale);
+    CHECK(scale >= settings.minScale);
+}
+
+// CPU瓶颈时降低分辨率没有用, 比例保持不变
+TEST(ResolutionController_cpuBoundHoldsScale) {
+    auto settings = testSettings();
+    ResolutionController controller(settings);
+    for (int i = 0; i < 100; ++i) {
+        CHECK(controller.update(settings.targetFrameTime / 2, settings.targetFrameTime * 3)
+              == settings.maxScale);
+    }
+
+    // 平滑后的GPU耗时要几帧才会超过目标
+    for (int i = 0; i < 10 && controller.scale() == settings.maxScale; ++i) {
+        controller.update(settings.targetFrameTime * 2, settings.targetFrameTime / 2);
+    }
+    auto lowered = controller.scale();
+    CHECK(lowered < settings.maxScale);
+    // GPU有余量但CPU超时, 也不能升高
+    for (int i = 0; i < 100; ++i) {
+        CHECK(controller.update(settings.targetFrameTime / 4, settings.targetFrameTime * 3)
+              == lowered);
+    }
+    // CPU恢复后才慢慢升回去
+    for (int i = 0; i < 100; ++i) {
+        controller.update(settings.targetFrameTime / 4, settings.targetFrameTime / 2);
+    }
+    CHECK(controller.scale() == settings.maxScale);
+}
+
+// 没有GPU计时的设备保持最大比例
+TEST(ResolutionController_noGpuTimeHoldsScale) {
+    auto settings = testSettings();
+    ResolutionController controller(settings);
+    for (int i = 0; i < 100; ++i) {
+        CHECK(controller.update(0, settings.targetFrameTime * 3) == settings.maxScale);
+    }
+}
+
+// 非法的范围只警告并返回false, 原来的范围不变
+TEST(ResolutionController_rejectsInvalidBounds) {
+    ResolutionController controller(testSettings());
+    CHECK(!controller.setBounds(0, 1));
+    CHECK(!controller.setBounds(.8f, .5f));
+    CHECK(!controller.setBounds(.5f, 1.5f));
+    CHECK(!controller.setBounds(NAN, 1));
+    CHECK(controller.settings().minScale == .5f);
+    CHECK(controller.settings().maxScale == 1);
+
+    CHECK(controller.setBounds(.25f, .75f));
+    CHECK(controller.scale() == .75f);
+}
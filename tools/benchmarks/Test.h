@@ -0,0 +1,38 @@
+#ifndef EGL_LEARNING_TEST_H
+#define EGL_LEARNING_TEST_H
+
+#include <cstdio>
+
+/*!
+ * Minimal host test registry for egl_tests, the counterpart of Benchmark.h:
+ *
+ *  TEST(example) {
+ *      CHECK(1 + 1 == 2);
+ *  }
+ *
+ * A failed @a CHECK() reports the expression and ends the test, the runner continues with the
+ * next one and exits non-zero if any failed.
+ */
+using TestFunction = void (*)();
+
+//! adds a test to the suite, @a TEST() does this at static initialization
+bool registerTest(const char *name, TestFunction function);
+
+//! records a failure of the running test
+void failTest(const char *file, int line, const char *expression);
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) { \
+            failTest(__FILE__, __LINE__, #expression); \
+            return; \
+        } \
+    } while (false)
+
+#define TEST(name) \
+    static void test_##name(); \
+    static const bool registered_##name = registerTest(#name, test_##name); \
+    static void test_##name()
+
+
+#endif //EGL_LEARNING_TEST_H
@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+    struct Registered {
+        const char *name;
+        TestFunction function;
+    };
+
+    std::vector<Registered> &registry() {
+        static std::vector<Registered> tests;
+        return tests;
+    }
+
+    bool failed = false;
+}
+
+bool registerTest(const char *name, TestFunction function) {
+    registry().push_back({name, function});
+    return true;
+}
+
+void failTest(const char *file, int line, const char *expression) {
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    failed = true;
+}
+
+int main(int argc, char **argv) {
+    const char *filter = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter substring]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    auto tests = registry();
+    std::sort(tests.begin(), tests.end(), [](const Registered &a, const Registered &b) {
+        return std::strcmp(a.name, b.name) < 0;
+    });
+
+    int run = 0;
+    int failures = 0;
+    for (auto &test: tests) {
+        if (filter && !std::strstr(test.name, filter)) continue;
+        failed = false;
+        auto start = std::chrono::steady_clock::now();
+        test.function();
+        auto milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        std::printf("%-6s %s (%.0f ms)\n", failed ? "FAIL" : "ok", test.name, milliseconds);
+        std::fflush(stdout);
+        ++run;
+        if (failed) ++failures;
+    }
+    std::printf("%d tests, %d failed\n", run, failures);
+    return failures || !run ? 1 : 0;
+}
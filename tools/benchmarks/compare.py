@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Compares two egl_benchmarks --json results and fails on regressions.
+
+A benchmark regresses when its median time per iteration grew by more than the threshold,
+0.10 meaning 10%. Exits with 1 if any did, 0 otherwise. Benchmarks present in only one of
+the files are listed but never fail the comparison.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as file:
+        return {benchmark["name"]: benchmark for benchmark in json.load(file)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed slowdown of the median, default 0.10")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = []
+    print(f"{'benchmark':36} {'baseline ns':>14} {'current ns':>14} {'change':>9}")
+    for name in sorted(baseline.keys() | current.keys()):
+        if name not in current:
+            print(f"{name:36} {baseline[name]['median_ns']:14.1f} {'missing':>14}")
+            continue
+        if name not in baseline:
+            print(f"{name:36} {'new':>14} {current[name]['median_ns']:14.1f}")
+            continue
+        before = baseline[name]["median_ns"]
+        after = current[name]["median_ns"]
+        change = after / before - 1 if before > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+        print(f"{name:36} {before:14.1f} {after:14.1f} {change:+8.1%}{marker}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than "
+              f"{args.threshold:.0%}: {', '.join(regressions)}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,51 @@
+// Host stand-in for the NDK header, only what the benchmarked sources use. AndroidBitmap_compress
+// writes the raw format of HostStubs.h instead of PNG/JPEG, so the stub decoder reads it back.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <android/data_space.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    ANDROID_BITMAP_RESULT_SUCCESS = 0,
+    ANDROID_BITMAP_RESULT_BAD_PARAMETER = -1,
+};
+
+enum AndroidBitmapFormat {
+    ANDROID_BITMAP_FORMAT_NONE = 0,
+    ANDROID_BITMAP_FORMAT_RGBA_8888 = 1,
+};
+
+enum {
+    ANDROID_BITMAP_FLAGS_ALPHA_PREMUL = 0,
+    ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE = 1,
+    ANDROID_BITMAP_FLAGS_ALPHA_UNPREMUL = 2,
+};
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    int32_t format;
+    uint32_t flags;
+} AndroidBitmapInfo;
+
+enum AndroidBitmapCompressFormat {
+    ANDROID_BITMAP_COMPRESS_FORMAT_JPEG = 0,
+    ANDROID_BITMAP_COMPRESS_FORMAT_PNG = 1,
+};
+
+typedef bool (*AndroidBitmap_CompressWriteFunc)(void *userContext, const void *data, size_t size);
+
+int AndroidBitmap_compress(const AndroidBitmapInfo *info, int32_t dataspace, const void *pixels,
+                           int32_t format, int32_t quality, void *userContext,
+                           AndroidBitmap_CompressWriteFunc fn);
+
+#ifdef __cplusplus
+}
+#endif
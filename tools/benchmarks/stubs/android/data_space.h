@@ -0,0 +1,7 @@
+// Host stand-in for the NDK header, only what the benchmarked sources use.
+#pragma once
+
+enum ADataSpace {
+    ADATASPACE_UNKNOWN = 0,
+    ADATASPACE_SRGB = 142671872,
+};
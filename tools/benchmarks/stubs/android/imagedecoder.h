@@ -0,0 +1,44 @@
+// Host stand-in for the NDK header. The decoder reads the raw format of HostStubs.h instead of
+// PNG/JPEG, so the benchmarks measure the app's side of Image::decode, not the codec.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <android/asset_manager.h>
+#include <android/bitmap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AImageDecoder AImageDecoder;
+typedef struct AImageDecoderHeaderInfo AImageDecoderHeaderInfo;
+
+enum {
+    ANDROID_IMAGE_DECODER_SUCCESS = 0,
+    ANDROID_IMAGE_DECODER_INCOMPLETE = -1,
+    ANDROID_IMAGE_DECODER_BAD_PARAMETER = -3,
+    ANDROID_IMAGE_DECODER_INVALID_INPUT = -5,
+};
+
+int AImageDecoder_createFromAAsset(AAsset *asset, AImageDecoder **outDecoder);
+
+void AImageDecoder_delete(AImageDecoder *decoder);
+
+int AImageDecoder_setAndroidBitmapFormat(AImageDecoder *decoder, int32_t format);
+
+const AImageDecoderHeaderInfo *AImageDecoder_getHeaderInfo(const AImageDecoder *decoder);
+
+int32_t AImageDecoderHeaderInfo_getWidth(const AImageDecoderHeaderInfo *info);
+
+int32_t AImageDecoderHeaderInfo_getHeight(const AImageDecoderHeaderInfo *info);
+
+int AImageDecoderHeaderInfo_getAlphaFlags(const AImageDecoderHeaderInfo *info);
+
+size_t AImageDecoder_getMinimumStride(AImageDecoder *decoder);
+
+int AImageDecoder_decodeImage(AImageDecoder *decoder, void *pixels, size_t stride, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,10 @@
+// Host stand-in for the NDK header, only what the benchmarked sources use.
+#pragma once
+
+enum {
+    AKEYCODE_C = 31,
+    AKEYCODE_D = 32,
+    AKEYCODE_O = 43,
+    AKEYCODE_P = 44,
+    AKEYCODE_R = 46,
+};
@@ -0,0 +1,24 @@
+// Host stand-in for the NDK header, only what the benchmarked sources use.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6,
+};
+
+int __android_log_write(int prio, const char *tag, const char *text);
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...);
+
+void __android_log_assert(const char *cond, const char *tag, const char *fmt, ...)
+__attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
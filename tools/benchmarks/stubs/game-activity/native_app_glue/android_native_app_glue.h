@@ -0,0 +1,68 @@
+// Host stand-in for the games-activity 1.2.2 glue, only the input buffer the benchmarked sources
+// read. Field order and array sizes follow the real headers so event batches cost the same.
+#pragma once
+
+#include <stdint.h>
+#include <android/input.h>
+
+#define GAMEACTIVITY_MAX_NUM_POINTERS_IN_MOTION_EVENT 8
+#define GAME_ACTIVITY_POINTER_INFO_AXIS_COUNT 48
+#define NATIVE_APP_GLUE_MAX_NUM_MOTION_EVENTS 16
+#define NATIVE_APP_GLUE_MAX_NUM_KEY_EVENTS 4
+
+typedef struct GameActivityPointerAxes {
+    int32_t id;
+    int32_t toolType;
+    float axisValues[GAME_ACTIVITY_POINTER_INFO_AXIS_COUNT];
+    float rawX;
+    float rawY;
+} GameActivityPointerAxes;
+
+inline float GameActivityPointerAxes_getX(const GameActivityPointerAxes *pointerInfo) {
+    return pointerInfo->axisValues[AMOTION_EVENT_AXIS_X];
+}
+
+inline float GameActivityPointerAxes_getY(const GameActivityPointerAxes *pointerInfo) {
+    return pointerInfo->axisValues[AMOTION_EVENT_AXIS_Y];
+}
+
+typedef struct GameActivityMotionEvent {
+    int32_t deviceId;
+    int32_t source;
+    int32_t action;
+    int64_t eventTime;
+    int64_t downTime;
+    int32_t flags;
+    int32_t metaState;
+    int32_t actionButton;
+    int32_t buttonState;
+    int32_t classification;
+    int32_t edgeFlags;
+    uint32_t pointerCount;
+    GameActivityPointerAxes pointers[GAMEACTIVITY_MAX_NUM_POINTERS_IN_MOTION_EVENT];
+    int historySize;
+    float precisionX;
+    float precisionY;
+} GameActivityMotionEvent;
+
+typedef struct GameActivityKeyEvent {
+    int32_t deviceId;
+    int32_t source;
+    int32_t action;
+    int64_t eventTime;
+    int64_t downTime;
+    int32_t flags;
+    int32_t metaState;
+    int32_t modifiers;
+    int32_t repeatCount;
+    int32_t keyCode;
+    int32_t scanCode;
+    int32_t unicodeChar;
+} GameActivityKeyEvent;
+
+struct android_input_buffer {
+    GameActivityMotionEvent motionEvents[NATIVE_APP_GLUE_MAX_NUM_MOTION_EVENTS];
+    uint64_t motionEventsCount;
+    GameActivityKeyEvent keyEvents[NATIVE_APP_GLUE_MAX_NUM_KEY_EVENTS];
+    uint64_t keyEventsCount;
+};
@@ -0,0 +1,703 @@
+#include "Replayer.h"
+
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+using namespace gltrace;
+
+namespace {
+    inline GLint i32(uint64_t value) { return static_cast<GLint>(static_cast<int64_t>(value)); }
+
+    inline GLuint u32(uint64_t value) { return static_cast<GLuint>(value); }
+
+    inline GLfloat f32(uint64_t value) {
+        auto bits = static_cast<uint32_t>(value);
+        GLfloat result;
+        std::memcpy(&result, &bits, sizeof result);
+        return result;
+    }
+
+    inline GLintptr iptr(uint64_t value) { return static_cast<GLintptr>(value); }
+
+    inline const void *offset(uint64_t value) { return reinterpret_cast<const void *>(value); }
+
+    //! cache keys: the call in the top bits, whatever the state is indexed by below
+    inline uint64_t key(Call call, uint64_t a = 0, uint64_t b = 0) {
+        return (uint64_t(call) << 48) | ((a & 0xffff) << 32) | (b & 0xffffffff);
+    }
+
+    double seconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+Replayer::Replayer()
+        : width_(0),
+          height_(0),
+          display_(EGL_NO_DISPLAY),
+          surface_(EGL_NO_SURFACE),
+          context_(EGL_NO_CONTEXT),
+          program_(0),
+          activeTexture_(GL_TEXTURE0),
+          feedback_(false),
+          calls_{},
+          executed_(0),
+          skipped_(0) {}
+
+Replayer::~Replayer() {
+    if (display_ != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context_ != EGL_NO_CONTEXT) eglDestroyContext(display_, context_);
+        if (surface_ != EGL_NO_SURFACE) eglDestroySurface(display_, surface_);
+        eglTerminate(display_);
+    }
+}
+
+bool Replayer::load(const std::string &path) {
+    auto file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    trace_.resize(std::ftell(file));
+    std::fseek(file, 0, SEEK_SET);
+    auto read = std::fread(trace_.data(), 1, trace_.size(), file);
+    std::fclose(file);
+
+    TraceHeader header{};
+    if (read != trace_.size() || trace_.size() < sizeof header) {
+        std::fprintf(stderr, "%s: truncated trace\n", path.c_str());
+        return false;
+    }
+    std::memcpy(&header, trace_.data(), sizeof header);
+    if (header.magic != kMagic || header.version != kVersion) {
+        std::fprintf(stderr, "%s: not a version %u trace\n", path.c_str(), kVersion);
+        return false;
+    }
+
+    // 离屏表面的大小取第一帧的大小
+    size_t position = sizeof header;
+    Record record{};
+    GLint unpackAlignment = 4;
+    while (_read(position, record, unpackAlignment)) {
+        if (record.header.call == kFrame) {
+            width_ = i32(record.args[0]);
+            height_ = i32(record.args[1]);
+            break;
+        }
+    }
+    if (width_ <= 0 || height_ <= 0) {
+        std::fprintf(stderr, "%s: no complete frame in trace\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Replayer::createContext() {
+    // Mesa can run without any window system, prefer that so no display server is needed
+    auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            display_ = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (display_ == EGL_NO_DISPLAY) display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (!eglInitialize(display_, nullptr, nullptr)) {
+        std::fprintf(stderr, "eglInitialize failed: 0x%x\n", eglGetError());
+        display_ = EGL_NO_DISPLAY;
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    constexpr EGLint attribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_BLUE_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_RED_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    eglChooseConfig(display_, attribs, &config, 1, &numConfigs);
+    if (!numConfigs) {
+        std::fprintf(stderr, "no GLES3 pbuffer config\n");
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, width_, EGL_HEIGHT, height_, EGL_NONE};
+    surface_ = eglCreatePbufferSurface(display_, config, surfaceAttribs);
+    constexpr EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, contextAttribs);
+    if (surface_ == EGL_NO_SURFACE || context_ == EGL_NO_CONTEXT
+        || !eglMakeCurrent(display_, surface_, surface_, context_)) {
+        std::fprintf(stderr, "headless context failure: 0x%x\n", eglGetError());
+        return false;
+    }
+    std::printf("replaying %dx%d on %s\n", width_, height_, glGetString(GL_RENDERER));
+    return true;
+}
+
+bool Replayer::run(const ReplayOptions &options) {
+    FILE *output = nullptr;
+    if (!options.output.empty()) {
+        output = std::fopen(options.output.c_str(), "wb");
+        if (!output) {
+            std::fprintf(stderr, "cannot create %s\n", options.output.c_str());
+            return false;
+        }
+        TraceHeader header{kMagic, kVersion};
+        std::fwrite(&header, sizeof header, 1, output);
+    }
+
+    int64_t frame = 0;
+    auto frameStart = std::chrono::steady_clock::now();
+    size_t position = sizeof(TraceHeader);
+    Record record{};
+    GLint unpackAlignment = 4;
+    while (frame <= options.lastFrame) {
+        auto start = position;
+        if (!_read(position, record, unpackAlignment)) break;
+        auto call = record.header.call;
+        auto &stats = calls_[call];
+
+        // 变换反馈的绘制更新的是缓冲, 属于状态, 不能跳过
+        if (call == kBeginTransformFeedback) feedback_ = true;
+        if (call == kEndTransformFeedback) feedback_ = false;
+        if (frame < options.firstFrame && !feedback_ && _producesPixels(call)) {
+            ++skipped_;
+            continue;
+        }
+        if (options.stripRedundant && _isRedundant(record)) {
+            ++stats.stripped;
+            continue;
+        }
+
+        auto before = std::chrono::steady_clock::now();
+        _execute(record);
+        if (call == kFrame && options.finish) glFinish();
+        auto after = std::chrono::steady_clock::now();
+        ++stats.count;
+        stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count();
+        ++executed_;
+        if (output) _write(output, record, position - start);
+
+        if (call == kFrame) {
+            if (frame >= options.firstFrame) frameTimes_.push_back(seconds(after - frameStart));
+            frameStart = after;
+            ++frame;
+        }
+    }
+    glFinish();
+
+    if (output && std::fclose(output) != 0) {
+        std::fprintf(stderr, "write failure %s\n", options.output.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Replayer::report(FILE *out) const {
+    std::vector<uint16_t> order;
+    for (uint16_t call = 0; call < kCallCount; ++call) {
+        if (calls_[call].count || calls_[call].stripped) order.push_back(call);
+    }
+    std::sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b) {
+        return calls_[a].nanoseconds > calls_[b].nanoseconds;
+    });
+
+    std::fprintf(out, "%-28s %10s %10s %12s %10s\n", "call", "count", "stripped", "total ms", "avg us");
+    for (auto call: order) {
+        auto &stats = calls_[call];
+        std::fprintf(out, "%-28s %10llu %10llu %12.3f %10.3f\n",
+                     callName(call),
+                     static_cast<unsigned long long>(stats.count),
+                     static_cast<unsigned long long>(stats.stripped),
+                     stats.nanoseconds / 1e6,
+                     stats.count ? stats.nanoseconds / 1e3 / stats.count : 0.);
+    }
+    std::fprintf(out, "%llu calls executed, %llu draws skipped before the first frame\n",
+                 static_cast<unsigned long long>(executed_),
+                 static_cast<unsigned long long>(skipped_));
+
+    if (frameTimes_.empty()) return;
+    auto sorted = frameTimes_;
+    std::sort(sorted.begin(), sorted.end());
+    auto mean = std::accumulate(sorted.begin(), sorted.end(), 0.) / sorted.size();
+    std::fprintf(out, "%zu frames, ms: mean %.3f, min %.3f, median %.3f, max %.3f\n",
+                 sorted.size(),
+                 mean * 1e3,
+                 sorted.front() * 1e3,
+                 sorted[sorted.size() / 2] * 1e3,
+                 sorted.back() * 1e3);
+}
+
+bool Replayer::_read(size_t &offset, Record &record, GLint &unpackAlignment) const {
+    if (offset + sizeof(RecordHeader) > trace_.size()) return false;
+    std::memcpy(&record.header, trace_.data() + offset, sizeof(RecordHeader));
+    auto &header = record.header;
+    auto argsSize = header.argCount * sizeof(uint64_t);
+    auto end = offset + sizeof(RecordHeader) + argsSize + header.payloadSize;
+    if (header.call >= kCallCount || header.argCount > std::size(record.args) || end > trace_.size()) {
+        std::fprintf(stderr, "corrupt record at byte %zu\n", offset);
+        return false;
+    }
+    std::memset(record.args, 0, sizeof record.args);
+    std::memcpy(record.args, trace_.data() + offset + sizeof(RecordHeader), argsSize);
+    record.payload = trace_.data() + offset + sizeof(RecordHeader) + argsSize;
+    if (!_payloadFits(record, unpackAlignment)) {
+        std::fprintf(stderr, "corrupt %s record at byte %zu\n", callName(header.call), offset);
+        return false;
+    }
+    // 每条记录都要读到, 跳过执行的帧也一样, 这样对齐值总和录制时一致
+    if (header.call == kPixelStorei && u32(record.args[0]) == GL_UNPACK_ALIGNMENT
+        && isUnpackAlignment(i32(record.args[1]))) {
+        unpackAlignment = i32(record.args[1]);
+    }
+    offset = end;
+    return true;
+}
+
+bool Replayer::_payloadFits(const Record &record, GLint unpackAlignment) {
+    auto &a = record.args;
+    auto payload = record.payload;
+    auto payloadSize = static_cast<uint64_t>(record.header.payloadSize);
+    // 数量来自记录本身, 不能相信; 先确认非负, 再和负载大小比较
+    auto holds = [&](GLint count, uint64_t elementSize) {
+        return count >= 0 && static_cast<uint64_t>(count) * elementSize <= payloadSize;
+    };
+    auto terminated = [&] {
+        return payloadSize > 0 && payload[payloadSize - 1] == '\0';
+    };
+
+    switch (record.header.call) {
+        case kDeleteBuffers:
+        case kDeleteFramebuffers:
+        case kDeleteQueries:
+        case kDeleteRenderbuffers:
+        case kDeleteTextures:
+        case kDeleteVertexArrays:
+        case kGenBuffers:
+        case kGenFramebuffers:
+        case kGenQueries:
+        case kGenRenderbuffers:
+        case kGenTextures:
+        case kGenVertexArrays:
+            return holds(i32(a[0]), sizeof(GLuint));
+        case kInvalidateFramebuffer:
+            return holds(i32(a[1]), sizeof(GLenum));
+        case kBufferData:
+            return payloadSize == 0 || (static_cast<int64_t>(a[1]) >= 0 && a[1] <= payloadSize);
+        case kGetUniformBlockIndex:
+        case kGetUniformLocation:
+            return terminated();
+        case kTexImage2D: {
+            // 没有负载时 GL 不读客户内存; 有负载就必须和录制端算出的大小一样长
+            auto width = i32(a[3]);
+            auto height = i32(a[4]);
+            if (payloadSize == 0) return true;
+            if (width < 0 || height < 0) return false;
+            // 按行比较, 宽高都很大时整幅图的字节数会溢出
+            auto row = imageSize(width, 1, u32(a[6]), u32(a[7]), unpackAlignment);
+            return row == 0 || static_cast<uint64_t>(height) <= payloadSize / row;
+        }
+        case kTransformFeedbackVaryings: {
+            auto count = i32(a[1]);
+            if (count < 0 || (count > 0 && !terminated())) return false;
+            return std::count(payload, payload + payloadSize, '\0') >= count;
+        }
+        default:
+            return true;
+    }
+}
+
+void Replayer::_write(FILE *file, const Record &record, size_t size) const {
+    // 原样写出, 回放时的名字映射不影响记录本身
+    auto begin = record.payload - sizeof(RecordHeader) - record.header.argCount * sizeof(uint64_t);
+    std::fwrite(begin, 1, size, file);
+}
+
+bool Replayer::_producesPixels(uint16_t call) {
+    switch (call) {
+        case kClear:
+        case kDrawArrays:
+        case kDrawElementsInstanced:
+        case kBlitFramebuffer:
+        case kReadPixels:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool Replayer::_isRedundant(const Record &record) {
+    auto &args = record.args;
+    auto set = [this](uint64_t stateKey, std::vector<uint64_t> value) {
+        auto &current = state_[stateKey];
+        if (current == value) return true;
+        current = std::move(value);
+        return false;
+    };
+
+    switch (record.header.call) {
+        case kActiveTexture:
+            activeTexture_ = args[0];
+            return set(key(kActiveTexture), {args[0]});
+        case kBindBuffer:
+            return set(key(kBindBuffer, args[0]), {args[1]});
+        case kBindBufferBase:
+        case kBindBufferRange:
+            // 带索引的绑定不缓存, 但它同时改变了通用绑定点
+            state_[key(kBindBuffer, args[0])] = {args[2]};
+            return false;
+        case kBindVertexArray:
+            // 元素缓冲的绑定属于VAO
+            state_.erase(key(kBindBuffer, GL_ELEMENT_ARRAY_BUFFER));
+            return set(key(kBindVertexArray), {args[0]});
+        case kBindTexture:
+            return set(key(kBindTexture, activeTexture_, args[0]), {args[1]});
+        case kBindRenderbuffer:
+            return set(key(kBindRenderbuffer), {args[1]});
+        case kBindFramebuffer: {
+            if (args[0] != GL_FRAMEBUFFER) return set(key(kBindFramebuffer, args[0]), {args[1]});
+            auto draw = set(key(kBindFramebuffer, GL_DRAW_FRAMEBUFFER), {args[1]});
+            auto read = set(key(kBindFramebuffer, GL_READ_FRAMEBUFFER), {args[1]});
+            return draw && read;
+        }
+        case kEnable:
+            return set(key(kEnable, args[0]), {1});
+        case kDisable:
+            return set(key(kEnable, args[0]), {0});
+        case kPixelStorei:
+            return set(key(kPixelStorei, args[0]), {args[1]});
+        case kUseProgram:
+            return set(key(kUseProgram), {args[0]});
+        case kBlendFunc:
+        case kDepthFunc:
+        case kDepthMask:
+        case kClearColor:
+        case kViewport:
+        case kScissor: {
+            auto call = static_cast<Call>(record.header.call);
+            return set(key(call), {args, args + record.header.argCount});
+        }
+        case kDeleteBuffers:
+        case kDeleteFramebuffers:
+        case kDeleteProgram:
+        case kDeleteRenderbuffers:
+        case kDeleteTextures:
+        case kDeleteVertexArrays:
+            // 名字可能被重用, 也可能隐式解绑, 整个缓存作废
+            state_.clear();
+            return false;
+        default:
+            return false;
+    }
+}
+
+GLuint Replayer::_lookup(const std::unordered_map<uint64_t, GLuint> &names, uint64_t recorded) {
+    if (!recorded) return 0;
+    auto name = names.find(recorded);
+    return name != names.end() ? name->second : 0;
+}
+
+void Replayer::_generate(const Record &record, void (*generate)(GLsizei, GLuint *),
+                         std::unordered_map<uint64_t, GLuint> &names) {
+    auto count = i32(record.args[0]);
+    std::vector<GLuint> recorded(count), created(count);
+    std::memcpy(recorded.data(), record.payload, count * sizeof(GLuint));
+    generate(count, created.data());
+    for (GLsizei i = 0; i < count; ++i) {
+        names[recorded[i]] = created[i];
+    }
+}
+
+void Replayer::_delete(const Record &record, void (*remove)(GLsizei, const GLuint *),
+                       std::unordered_map<uint64_t, GLuint> &names) {
+    auto count = i32(record.args[0]);
+    std::vector<GLuint> recorded(count), deleted(count);
+    std::memcpy(recorded.data(), record.payload, count * sizeof(GLuint));
+    for (GLsizei i = 0; i < count; ++i) {
+        deleted[i] = _lookup(names, recorded[i]);
+        names.erase(recorded[i]);
+    }
+    remove(count, deleted.data());
+}
+
+void Replayer::_execute(const Record &record) {
+    auto &a = record.args;
+    auto payload = record.payload;
+    auto payloadSize = record.header.payloadSize;
+
+    switch (record.header.call) {
+        case kFrame:
+            eglSwapBuffers(display_, surface_);
+            break;
+        case kActiveTexture:
+            glActiveTexture(u32(a[0]));
+            break;
+        case kAttachShader:
+            glAttachShader(_lookup(programs_, a[0]), _lookup(programs_, a[1]));
+            break;
+        case kBeginQuery:
+            glBeginQuery(u32(a[0]), _lookup(queries_, a[1]));
+            break;
+        case kBeginTransformFeedback:
+            glBeginTransformFeedback(u32(a[0]));
+            break;
+        case kBindBuffer:
+            glBindBuffer(u32(a[0]), _lookup(buffers_, a[1]));
+            break;
+        case kBindBufferBase:
+            glBindBufferBase(u32(a[0]), u32(a[1]), _lookup(buffers_, a[2]));
+            break;
+        case kBindBufferRange:
+            glBindBufferRange(u32(a[0]), u32(a[1]), _lookup(buffers_, a[2]), iptr(a[3]), iptr(a[4]));
+            break;
+        case kBindFramebuffer:
+            glBindFramebuffer(u32(a[0]), _lookup(framebuffers_, a[1]));
+            break;
+        case kBindRenderbuffer:
+            glBindRenderbuffer(u32(a[0]), _lookup(renderbuffers_, a[1]));
+            break;
+        case kBindTexture:
+            glBindTexture(u32(a[0]), _lookup(textures_, a[1]));
+            break;
+        case kBindVertexArray:
+            glBindVertexArray(_lookup(vertexArrays_, a[0]));
+            break;
+        case kBlendFunc:
+            glBlendFunc(u32(a[0]), u32(a[1]));
+            break;
+        case kBlitFramebuffer:
+            glBlitFramebuffer(i32(a[0]), i32(a[1]), i32(a[2]), i32(a[3]),
+                              i32(a[4]), i32(a[5]), i32(a[6]), i32(a[7]),
+                              u32(a[8]), u32(a[9]));
+            break;
+        case kBufferData:
+            glBufferData(u32(a[0]), iptr(a[1]), payloadSize ? payload : nullptr, u32(a[2]));
+            break;
+        case kClear:
+            glClear(u32(a[0]));
+            break;
+        case kClearColor:
+            glClearColor(f32(a[0]), f32(a[1]), f32(a[2]), f32(a[3]));
+            break;
+        case kClientWaitSync: {
+            auto sync = syncs_.find(a[0]);
+            if (sync != syncs_.end()) glClientWaitSync(sync->second, u32(a[1]), a[2]);
+            break;
+        }
+        case kCompileShader:
+            glCompileShader(_lookup(programs_, a[0]));
+            break;
+        case kCreateProgram:
+            programs_[a[0]] = glCreateProgram();
+            break;
+        case kCreateShader:
+            programs_[a[1]] = glCreateShader(u32(a[0]));
+            break;
+        case kDeleteBuffers:
+            _delete(record, glDeleteBuffers, buffers_);
+            break;
+        case kDeleteFramebuffers:
+            _delete(record, glDeleteFramebuffers, framebuffers_);
+            break;
+        case kDeleteProgram:
+            glDeleteProgram(_lookup(programs_, a[0]));
+            programs_.erase(a[0]);
+            break;
+        case kDeleteQueries:
+            _delete(record, glDeleteQueries, queries_);
+            break;
+        case kDeleteRenderbuffers:
+            _delete(record, glDeleteRenderbuffers, renderbuffers_);
+            break;
+        case kDeleteShader:
+            glDeleteShader(_lookup(programs_, a[0]));
+            programs_.erase(a[0]);
+            break;
+        case kDeleteSync: {
+            auto sync = syncs_.find(a[0]);
+            if (sync != syncs_.end()) {
+                glDeleteSync(sync->second);
+                syncs_.erase(sync);
+            }
+            break;
+        }
+        case kDeleteTextures:
+            _delete(record, glDeleteTextures, textures_);
+            break;
+        case kDeleteVertexArrays:
+            _delete(record, glDeleteVertexArrays, vertexArrays_);
+            break;
+        case kDepthFunc:
+            glDepthFunc(u32(a[0]));
+            break;
+        case kDepthMask:
+            glDepthMask(static_cast<GLboolean>(a[0]));
+            break;
+        case kDisable:
+            glDisable(u32(a[0]));
+            break;
+        case kDrawArrays:
+            glDrawArrays(u32(a[0]), i32(a[1]), i32(a[2]));
+            break;
+        case kDrawElementsInstanced:
+            glDrawElementsInstanced(u32(a[0]), i32(a[1]), u32(a[2]), offset(a[3]), i32(a[4]));
+            break;
+        case kEnable:
+            glEnable(u32(a[0]));
+            break;
+        case kEnableVertexAttribArray:
+            glEnableVertexAttribArray(u32(a[0]));
+            break;
+        case kEndQuery:
+            glEndQuery(u32(a[0]));
+            break;
+        case kEndTransformFeedback:
+            glEndTransformFeedback();
+            break;
+        case kFenceSync:
+            syncs_[a[2]] = glFenceSync(u32(a[0]), u32(a[1]));
+            break;
+        case kFramebufferRenderbuffer:
+            glFramebufferRenderbuffer(u32(a[0]), u32(a[1]), u32(a[2]), _lookup(renderbuffers_, a[3]));
+            break;
+        case kGenBuffers:
+            _generate(record, glGenBuffers, buffers_);
+            break;
+        case kGenFramebuffers:
+            _generate(record, glGenFramebuffers, framebuffers_);
+            break;
+        case kGenQueries:
+            _generate(record, glGenQueries, queries_);
+            break;
+        case kGenRenderbuffers:
+            _generate(record, glGenRenderbuffers, renderbuffers_);
+            break;
+        case kGenTextures:
+            _generate(record, glGenTextures, textures_);
+            break;
+        case kGenVertexArrays:
+            _generate(record, glGenVertexArrays, vertexArrays_);
+            break;
+        case kGenerateMipmap:
+            glGenerateMipmap(u32(a[0]));
+            break;
+        case kGetUniformBlockIndex: {
+            auto name = reinterpret_cast<const GLchar *>(payload);
+            blockIndices_[{a[0], a[1]}] = glGetUniformBlockIndex(_lookup(programs_, a[0]), name);
+            break;
+        }
+        case kGetUniformLocation: {
+            auto name = reinterpret_cast<const GLchar *>(payload);
+            locations_[{a[0], i32(a[1])}] = glGetUniformLocation(_lookup(programs_, a[0]), name);
+            break;
+        }
+        case kInvalidateFramebuffer: {
+            std::vector<GLenum> attachments(i32(a[1]));
+            std::memcpy(attachments.data(), payload, attachments.size() * sizeof(GLenum));
+            glInvalidateFramebuffer(u32(a[0]), i32(a[1]), attachments.data());
+            break;
+        }
+        case kLinkProgram:
+            glLinkProgram(_lookup(programs_, a[0]));
+            break;
+        case kMapBufferRange: {
+            auto data = glMapBufferRange(u32(a[0]), iptr(a[1]), iptr(a[2]), u32(a[3]));
+            if (data) mappings_[a[4]] = {static_cast<uint8_t *>(data), iptr(a[2])};
+            break;
+        }
+        case kPixelStorei:
+            glPixelStorei(u32(a[0]), i32(a[1]));
+            break;
+        case kReadPixels: {
+            // 没有绑定PACK缓冲时, 记录下来的是应用的内存地址, 换成自己的
+            GLint packBuffer = 0;
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+            void *pixels = const_cast<void *>(offset(a[6]));
+            if (!packBuffer) {
+                readScratch_.resize(static_cast<size_t>(i32(a[2])) * i32(a[3]) * 16);
+                pixels = readScratch_.data();
+            }
+            glReadPixels(i32(a[0]), i32(a[1]), i32(a[2]), i32(a[3]), u32(a[4]), u32(a[5]), pixels);
+            break;
+        }
+        case kRenderbufferStorage:
+            glRenderbufferStorage(u32(a[0]), u32(a[1]), i32(a[2]), i32(a[3]));
+            break;
+        case kScissor:
+            glScissor(i32(a[0]), i32(a[1]), i32(a[2]), i32(a[3]));
+            break;
+        case kShaderSource: {
+            auto source = reinterpret_cast<const GLchar *>(payload);
+            auto length = static_cast<GLint>(payloadSize);
+            glShaderSource(_lookup(programs_, a[0]), 1, &source, &length);
+            break;
+        }
+        case kTexImage2D:
+            glTexImage2D(u32(a[0]), i32(a[1]), i32(a[2]), i32(a[3]), i32(a[4]), i32(a[5]),
+                         u32(a[6]), u32(a[7]), payloadSize ? payload : nullptr);
+            break;
+        case kTexParameteri:
+            glTexParameteri(u32(a[0]), u32(a[1]), i32(a[2]));
+            break;
+        case kTransformFeedbackVaryings: {
+            std::vector<const GLchar *> names;
+            auto name = reinterpret_cast<const GLchar *>(payload);
+            for (auto i = 0; i < i32(a[1]); ++i) {
+                names.push_back(name);
+                name += std::strlen(name) + 1;
+            }
+            glTransformFeedbackVaryings(_lookup(programs_, a[0]), i32(a[1]), names.data(), u32(a[2]));
+            break;
+        }
+        case kUniform1i: {
+            auto location = locations_.find({program_, i32(a[0])});
+            glUniform1i(location != locations_.end() ? location->second : i32(a[0]), i32(a[1]));
+            break;
+        }
+        case kUniformBlockBinding: {
+            auto index = blockIndices_.find({a[0], a[1]});
+            glUniformBlockBinding(_lookup(programs_, a[0]),
+                                  index != blockIndices_.end() ? index->second : u32(a[1]),
+                                  u32(a[2]));
+            break;
+        }
+        case kUnmapBuffer: {
+            // 应用写进映射内存的内容在这里重放
+            auto mapping = mappings_.find(a[1]);
+            if (mapping != mappings_.end()) {
+                auto size = std::min<size_t>(payloadSize, mapping->second.length);
+                if (size) std::memcpy(mapping->second.data, payload, size);
+                mappings_.erase(mapping);
+            }
+            glUnmapBuffer(u32(a[0]));
+            break;
+        }
+        case kUseProgram:
+            program_ = a[0];
+            glUseProgram(_lookup(programs_, a[0]));
+            break;
+        case kVertexAttribDivisor:
+            glVertexAttribDivisor(u32(a[0]), u32(a[1]));
+            break;
+        case kVertexAttribPointer:
+            glVertexAttribPointer(u32(a[0]), i32(a[1]), u32(a[2]), static_cast<GLboolean>(a[3]),
+                                  i32(a[4]), offset(a[5]));
+            break;
+        case kViewport:
+            glViewport(i32(a[0]), i32(a[1]), i32(a[2]), i32(a[3]));
+            break;
+        default:
+            break;
+    }
+}
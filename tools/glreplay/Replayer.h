@@ -0,0 +1,140 @@
+#ifndef EGL_LEARNING_REPLAYER_H
+#define EGL_LEARNING_REPLAYER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include "GlTraceFormat.h"
+
+struct ReplayOptions {
+    //! frames before this one only replay state and resource calls, no draws, clears or copies
+    //! except transform feedback draws
+    int64_t firstFrame = 0;
+    //! last frame replayed, inclusive
+    int64_t lastFrame = std::numeric_limits<int64_t>::max();
+    //! drop state calls that set what is already set
+    bool stripRedundant = false;
+    //! glFinish at the end of every frame, so frame times include the GPU work
+    bool finish = false;
+    //! if set, the calls that were executed are written here as a new trace
+    std::string output;
+};
+
+/*!
+ * Re-executes a trace recorded by GlTrace.cpp against a headless EGL context.
+ *
+ * Object names, uniform locations, block indices, fences and buffer mappings are remapped from
+ * the recorded values to the ones this driver returns. Every executed call is timed on the CPU,
+ * so the report shows where submission time goes; with @a ReplayOptions::finish the frame times
+ * include the GPU as well.
+ */
+class Replayer {
+public:
+    Replayer();
+
+    ~Replayer();
+
+    //! reads the whole trace into memory and checks the header
+    bool load(const std::string &path);
+
+    //! creates a pbuffer context the size of the first recorded frame
+    bool createContext();
+
+    bool run(const ReplayOptions &options);
+
+    void report(FILE *out) const;
+
+private:
+    struct Record {
+        gltrace::RecordHeader header;
+        //! copied out of the file, the payload keeps records unaligned
+        uint64_t args[12];
+        const uint8_t *payload;
+    };
+
+    struct CallStats {
+        uint64_t count = 0;
+        uint64_t stripped = 0;
+        uint64_t nanoseconds = 0;
+    };
+
+    struct Mapping {
+        uint8_t *data;
+        GLsizeiptr length;
+    };
+
+    /*!
+     * @param unpackAlignment GL_UNPACK_ALIGNMENT as of the records read so far, updated by
+     * glPixelStorei records; start every pass over the trace at GL's default of 4
+     * @return false on a truncated record, or one whose payload is too short for its arguments
+     */
+    bool _read(size_t &offset, Record &record, GLint &unpackAlignment) const;
+
+    //! true if the payload holds everything the record's counts say, strings and images included
+    static bool _payloadFits(const Record &record, GLint unpackAlignment);
+
+    void _execute(const Record &record);
+
+    //! true if the call only sets state that the cache says is already set
+    bool _isRedundant(const Record &record);
+
+    //! draws and copies, skipped before the first selected frame
+    static bool _producesPixels(uint16_t call);
+
+    void _write(FILE *file, const Record &record, size_t size) const;
+
+    //! recorded name to replay name, 0 stays 0
+    static GLuint _lookup(const std::unordered_map<uint64_t, GLuint> &names, uint64_t recorded);
+
+    void _generate(const Record &record, void (*generate)(GLsizei, GLuint *),
+                   std::unordered_map<uint64_t, GLuint> &names);
+
+    void _delete(const Record &record, void (*remove)(GLsizei, const GLuint *),
+                 std::unordered_map<uint64_t, GLuint> &names);
+
+    std::vector<uint8_t> trace_;
+    EGLint width_;
+    EGLint height_;
+
+    EGLDisplay display_;
+    EGLSurface surface_;
+    EGLContext context_;
+
+    std::unordered_map<uint64_t, GLuint> buffers_;
+    std::unordered_map<uint64_t, GLuint> textures_;
+    std::unordered_map<uint64_t, GLuint> vertexArrays_;
+    std::unordered_map<uint64_t, GLuint> framebuffers_;
+    std::unordered_map<uint64_t, GLuint> renderbuffers_;
+    std::unordered_map<uint64_t, GLuint> queries_;
+    //! programs and shaders share one namespace in GL
+    std::unordered_map<uint64_t, GLuint> programs_;
+    std::unordered_map<uint64_t, GLsync> syncs_;
+    //! keyed by recorded program and recorded location or block index
+    std::map<std::pair<uint64_t, int64_t>, GLint> locations_;
+    std::map<std::pair<uint64_t, uint64_t>, GLuint> blockIndices_;
+    //! keyed by recorded buffer name
+    std::unordered_map<uint64_t, Mapping> mappings_;
+    uint64_t program_;
+    std::vector<uint8_t> readScratch_;
+
+    //! last values set per state key, in recorded names
+    std::unordered_map<uint64_t, std::vector<uint64_t>> state_;
+    uint64_t activeTexture_;
+    //! inside glBeginTransformFeedback, draws there write buffers the later frames read
+    bool feedback_;
+
+    CallStats calls_[gltrace::kCallCount];
+    std::vector<double> frameTimes_;
+    uint64_t executed_;
+    uint64_t skipped_;
+};
+
+
+#endif //EGL_LEARNING_REPLAYER_H
@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Replayer.h"
+
+static void usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s [options] <trace>\n"
+                 "  --frames A:B       replay frames A to B (inclusive), earlier frames only\n"
+                 "                     set up state and resources; A: or :B leave a side open\n"
+                 "  --strip-redundant  drop state calls that set the current value again\n"
+                 "  --finish           glFinish after every frame, frame times include the GPU\n"
+                 "  --output <file>    write the executed calls as a new trace\n",
+                 program);
+}
+
+static bool parseFrames(const char *text, ReplayOptions &options) {
+    auto colon = std::strchr(text, ':');
+    if (!colon) return false;
+    if (colon != text) options.firstFrame = std::strtoll(text, nullptr, 10);
+    if (colon[1]) options.lastFrame = std::strtoll(colon + 1, nullptr, 10);
+    return options.firstFrame >= 0 && options.firstFrame <= options.lastFrame;
+}
+
+int main(int argc, char **argv) {
+    ReplayOptions options;
+    const char *trace = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) {
+            if (!parseFrames(argv[++i], options)) {
+                std::fprintf(stderr, "bad frame range %s\n", argv[i]);
+                return 2;
+            }
+        } else if (!std::strcmp(argv[i], "--strip-redundant")) {
+            options.stripRedundant = true;
+        } else if (!std::strcmp(argv[i], "--finish")) {
+            options.finish = true;
+        } else if (!std::strcmp(argv[i], "--output") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (argv[i][0] != '-' && !trace) {
+            trace = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!trace) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Replayer replayer;
+    if (!replayer.load(trace) || !replayer.createContext() || !replayer.run(options)) {
+        return 1;
+    }
+    replayer.report(stdout);
+    return 0;
+}